@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+# define ARENA_H
+
+# include <stddef.h>
+
+/* Address space reserved per arena, pages are only touched on use */
+# define ARENA_PARSE_SIZE 67108864
+# define ARENA_SCRATCH_SIZE 67108864
+# define ARENA_HUGE_PAGE 2097152
+# define ARENA_ALIGN 16
+
+/*
+** Bump allocator over one anonymous mapping. Allocations are never freed
+** one by one: take a mark, allocate, then reset to the mark, or drop the
+** whole region with arena_destroy.
+*/
+typedef struct s_arena
+{
+	char			*base;
+	size_t			size;
+	size_t			used;
+}					t_arena;
+
+int					arena_init(t_arena *arena, size_t size, int huge);
+void				*arena_alloc(t_arena *arena, size_t size);
+size_t				arena_mark(const t_arena *arena);
+void				arena_reset(t_arena *arena, size_t mark);
+void				arena_destroy(t_arena *arena);
+
+#endif
@@ -7,19 +7,74 @@
 # include <limits.h>
 # include <math.h>
 # include <mlx.h>
+# include <stdio.h>
 # include <stdlib.h>
 # include <unistd.h>
 
 # define TRUE 1
 # define FALSE 0
 
-# define WIDTH 800
-# define HEIGHT 600
+# define WIDTH 1920
+# define HEIGHT 1080
+# define MAX_IMAGE_SIDE 32768
 # define WINDOW_NAME_RT "miniRT"
 
+/* X11 keysyms, buttons and events handled by the window */
+# define KEY_ESC 65307
+# define KEY_R 114
+# define KEY_W 119
+# define KEY_A 97
+# define KEY_S 115
+# define KEY_D 100
+# define KEY_Q 113
+# define KEY_E 101
+# define KEY_LEFT 65361
+# define KEY_UP 65362
+# define KEY_RIGHT 65363
+# define KEY_DOWN 65364
+# define KEY_I 105
+# define KEY_J 106
+# define KEY_K 107
+# define KEY_L 108
+# define KEY_U 117
+# define KEY_O 111
+# define KEY_C 99
+# define KEY_COMMA 44
+# define KEY_PERIOD 46
+# define KEY_BRACKET_L 91
+# define KEY_BRACKET_R 93
+# define MOUSE_LEFT 1
+# define MOUSE_RIGHT 3
+# define EVENT_KEY_PRESS 2
+# define EVENT_BUTTON_PRESS 4
+# define EVENT_BUTTON_RELEASE 5
+# define EVENT_MOTION 6
+# define EVENT_DESTROY 17
+
+/*
+** Interactive controls: world units per key press, radians per arrow
+** press and per pixel of mouse-look. While the user edits, frames trace
+** one ray per PREVIEW_BLOCK x PREVIEW_BLOCK pixels, which must divide
+** TILE_SIZE so a block never leaves its tile.
+*/
+# define MOVE_STEP 0.5
+# define TURN_STEP 0.05
+# define MOUSE_TURN 0.004
+# define PITCH_LIMIT 0.99
+# define PREVIEW_BLOCK 4
+# define LIGHT_STEP 1.0
+# define LIGHT_GAIN 0.05
+
+/* Kinds of edit made since the last committed frame */
+# define CHANGED_CAMERA 1
+# define CHANGED_GEOMETRY 2
+# define CHANGED_LIGHT 4
+# define CHANGED_SHADING 8
+
 // # include "constants.h"
 // # include "intersections.h"
 # include "parser.h"
+# include "render.h"
 # include "scene_math.h"
 
 /* Error codes */
@@ -29,6 +84,96 @@
 # define ERR_SCENE "Error: Invalid scene configuration\n"
 # define ERR_MEMORY "Error: Memory allocation failed\n"
 # define ERR_FILE_FORMAT "Error: File must have .rt extension\n"
+# define ERR_ORDER "Error: Unknown traversal order '%s'\n"
+# define ERR_OUTPUT "Error: Could not write image %s\n"
+# define ERR_PARSE_THREADS "Error: Invalid parse thread count '%s'\n"
+# define ERR_SIZE "Error: Invalid image size '%s', expected WxH\n"
+# define ERR_EXPOSURE "Error: Invalid exposure '%s'\n"
+# define ERR_TONEMAP "Error: Unknown tone curve '%s'\n"
+# define ERR_MAX_MEMORY "Error: Invalid memory budget '%s'\n"
+# define ERR_BAND "Error: Memory budget below one band of %d rows\n"
+# define ERR_WORKERS "Error: Invalid worker count '%s'\n"
+# define ERR_CAMERA "Error: Invalid camera override %s '%s'\n"
+# define ERR_SERVER "Error: Could not listen on %s\n"
+# define ERR_JOBS "Error: Could not read job list %s\n"
+# define ERR_JOB "Error: Job on line %d of the list failed\n"
+# define ERR_FRAMES "Error: Invalid frame count '%s'\n"
+# define ERR_KEYFRAME "Error: Invalid keyframe on line %d of %s\n"
+# define ERR_KEYFRAMES "Error: %s needs two keyframes or more, in time \
+order\n"
+# define ERR_ANIMATE "Error: --animate renders PPM frames to --output, \
+without --max-memory, --checkpoint or --workers\n"
+# define ERR_PERIOD "Error: Invalid checkpoint period '%s'\n"
+# define ERR_CHECKPOINT "Error: Could not write checkpoint %s\n"
+# define ERR_RESUME "Error: Checkpoint %s is unreadable or for another \
+scene\n"
+# define USAGE "Usage: ./minirt <scene.rt> [--order row|morton|hilbert] \
+[--bench] [--output file.ppm|file.pfm] [--size WxH] [--parse-threads n] \
+[--exposure e] [--tonemap linear|srgb] [--max-memory bytes[K|M|G]] \
+[--checkpoint seconds] [--resume] [--workers n] [--camera x,y,z] \
+[--look x,y,z] [--fov degrees] [--animate keyframes] [--frames n]\n\
+       ./minirt --server socket\n\
+       ./minirt --jobs list\n"
+
+/*
+** Banded output: bytes held per pixel of a band besides the output file,
+** the float framebuffer and the packed image. The PFM scale's sign gives
+** the byte order of its floats.
+*/
+# define STREAM_PIXEL_BYTES 16
+# if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#  define PFM_SCALE "1.0"
+# else
+#  define PFM_SCALE "-1.0"
+# endif
+
+/*
+** Checkpoints of headless renders go next to the output, written to
+** CHECKPOINT_TEMP first so a save cut short leaves the last one intact.
+** Saves happen between runs of CHECKPOINT_TILES tiles once the period,
+** CHECKPOINT_PERIOD seconds unless given, is up.
+*/
+# define CHECKPOINT_MAGIC "MRTCKPT1"
+# define CHECKPOINT_SUFFIX ".ckpt"
+# define CHECKPOINT_TEMP ".ckpt.tmp"
+# define CHECKPOINT_TILES 256
+# define CHECKPOINT_PERIOD 60
+
+/*
+** Distributed rendering: up to MAX_WORKERS worker processes, each sent
+** up to FARM_DEPTH tiles ahead so it never waits for the next one
+*/
+# define MAX_WORKERS 64
+# define FARM_DEPTH 2
+
+/* Camera overrides given on the command line or in a server request */
+# define OVERRIDE_POSITION 1
+# define OVERRIDE_DIRECTION 2
+# define OVERRIDE_FOV 4
+
+/*
+** Render server: at most SERVER_CLIENTS connections and SERVER_SCENES
+** cached scenes at a time, requests of at most SERVER_LINE bytes and
+** SERVER_ARGS words
+*/
+# define SERVER_CLIENTS 64
+# define SERVER_SCENES 16
+# define SERVER_LINE 4096
+# define SERVER_ARGS 64
+# define SERVER_BACKLOG 16
+
+/*
+** Camera animation: keyframe times are in seconds, played at
+** ANIMATION_FPS unless a frame count is given
+*/
+# define ANIMATION_FPS 24
+# define MAX_FRAMES 100000
+
+/* Hardware counters reported by the benchmark */
+# define PERF_CACHE_REFS 0
+# define PERF_CACHE_MISSES 1
+# define PERF_L1D_MISSES 2
+# define PERF_NUM_COUNTERS 3
 
 /* Image structure */
 typedef struct s_image
@@ -40,25 +185,377 @@ typedef struct s_image
 	int					endian;
 }						t_image;
 
+/*
+** Input state. selected is the picked object, -1 for the camera. Object
+** moves add up in drag while a frame is running and are applied between
+** frames, when no worker reads the scene; edited asks for the next frame
+** to be a preview. Light, ambient and recolor hold the same kind of
+** pending lighting edits. since gathers the CHANGED_ kinds of edit made
+** after the last committed frame, which decide what of it the next
+** frame may reuse; refresh counts the reprojected frames still due to
+** retrace the rest of the image once the camera stops. look is set
+** while the right button is held, mouse is the last pointer position.
+*/
+typedef struct s_controls
+{
+	int					selected;
+	t_vec3				drag;
+	int					edited;
+	t_light				light;
+	t_ambient			ambient;
+	int					recolor;
+	int					since;
+	int					refresh;
+	int					look;
+	int					mouse[2];
+}						t_controls;
+
 /* Main program variables structure */
 typedef struct s_vars
 {
 	void				*mlx;
 	void				*win;
 	t_image				*img;
+	t_scene				*scene;
+	t_render			render;
+	t_controls			controls;
+	char				*back;
 }						t_vars;
 
-typedef struct s_hit	t_hit;
+/*
+** Command line options. camera has an OVERRIDE_* bit set for each
+** camera override given. compiled, when set, is the scene already
+** compiled by the render server, shared by the renders using it.
+*/
+typedef struct s_options
+{
+	char				*scene_path;
+	char				*output;
+	int					order;
+	int					bench;
+	int					parse_threads;
+	int					width;
+	int					height;
+	double				exposure;
+	int					transfer;
+	size_t				max_memory;
+	int					checkpoint;
+	int					resume;
+	int					workers;
+	char				*server;
+	char				*jobs;
+	char				*animate;
+	int					frames;
+	int					camera;
+	t_vec3				camera_position;
+	t_vec3				camera_direction;
+	double				fov;
+	const t_compiled	*compiled;
+}						t_options;
+
+/* Output file written band by band through a shared mapping */
+typedef struct s_stream
+{
+	const char			*path;
+	int					fd;
+	int					pfm;
+	int					width;
+	int					height;
+	size_t				header;
+	size_t				row_bytes;
+	int					kept;
+}						t_stream;
+
+/*
+** Checkpoint state of a headless render. hash identifies the scene file
+** and the options shaping the image, fd is the output file, synced
+** before every save, saved the time of the last one.
+*/
+typedef struct s_checkpoint
+{
+	char				*path;
+	char				*temp;
+	unsigned long		hash;
+	int					period;
+	int					resume;
+	int					tiles;
+	int					fd;
+	long				saved;
+}						t_checkpoint;
+
+/*
+** Worker processes of a distributed render, fd being the coordinator's
+** end of each one's socket, -1 once the worker is gone. sent holds the
+** tiles each was sent and has not returned, oldest first, requeue the
+** tiles taken back from dead workers, cursor the next tile in traversal
+** order.
+*/
+typedef struct s_farm
+{
+	int					count;
+	int					fd[MAX_WORKERS];
+	pid_t				pid[MAX_WORKERS];
+	int					sent[MAX_WORKERS][FARM_DEPTH];
+	int					pending[MAX_WORKERS];
+	int					*requeue;
+	int					requeued;
+	int					cursor;
+}						t_farm;
+
+/*
+** Version of a scene file as stat reports it: modification time to the
+** nanosecond, size and inode, so saves within a second or a file
+** replaced by another still tell apart
+*/
+typedef struct s_version
+{
+	long				sec;
+	long				nsec;
+	long				size;
+	long				inode;
+}						t_version;
+
+/*
+** A scene of the render server's cache, parsed with its hierarchy and
+** compiled once for every request naming it. users counts the requests
+** rendering from it, used is the server's clock when it was last taken
+** and version that of the file it was read from. An entry dropped from
+** the cache is freed by its last user.
+*/
+typedef struct s_cached
+{
+	char				*path;
+	t_version			version;
+	t_scene				*scene;
+	t_compiled			compiled;
+	int					users;
+	int					dropped;
+	unsigned long		used;
+}						t_cached;
+
+/*
+** Render server state. clients holds the socket of each connection, -1
+** for a free slot, active counts their threads. lock guards it all but
+** the listening socket, load serializes scene loading.
+*/
+typedef struct s_server
+{
+	int					fd;
+	int					stop;
+	int					clients[SERVER_CLIENTS];
+	int					active;
+	t_cached			*cache[SERVER_SCENES];
+	unsigned long		clock;
+	unsigned long		served;
+	unsigned long		hits;
+	double				total_ms;
+	pthread_mutex_t		lock;
+	pthread_mutex_t		load;
+}						t_server;
+
+/* What the thread serving a connection is handed */
+typedef struct s_client
+{
+	t_server			*server;
+	int					slot;
+}						t_client;
+
+/*
+** A job of a job list: its line, the words it splits into and the
+** options they give, ok when those are valid. entry is the cached scene
+** it renders from, cache where that comes from.
+*/
+typedef struct s_job
+{
+	char				*line;
+	size_t				size;
+	int					number;
+	char				*argv[SERVER_ARGS];
+	t_options			opts;
+	int					ok;
+	t_server			*cache;
+	t_cached			*entry;
+	int					hit;
+}						t_job;
+
+/*
+** Job list run: the file, the render server's scene cache without its
+** socket, the job rendering and the one loading, and what got done
+*/
+typedef struct s_jobs
+{
+	FILE				*file;
+	int					line;
+	t_server			cache;
+	t_job				job[2];
+	int					done;
+	int					failed;
+	int					loaded;
+	double				pixels;
+}						t_jobs;
+
+/* Where the camera is at time, in seconds, along an animation */
+typedef struct s_keyframe
+{
+	double				time;
+	t_camera			camera;
+}						t_keyframe;
+
+/* Keyframes of a camera animation in time order, size allocated */
+typedef struct s_animation
+{
+	t_keyframe			*keys;
+	int					count;
+	int					size;
+}						t_animation;
+
+/* A frame for the encoder thread to write, ok once written */
+typedef struct s_encode
+{
+	const t_options		*opts;
+	const char			*addr;
+	int					frame;
+	int					ok;
+}						t_encode;
+
+/*
+** One of the two renders of an animation, each with its own copy of the
+** scene for the camera of the frame it is given. ok tells whether the
+** frame was set up.
+*/
+typedef struct s_stage
+{
+	t_scene				scene;
+	t_render			render;
+	int					ok;
+}						t_stage;
+
+/*
+** Animation run: the keyframes, the scene compiled once for the two
+** stages, staged of them set up, and the frame being encoded, encoding
+** telling whether its thread runs
+*/
+typedef struct s_reel
+{
+	t_animation			anim;
+	int					frames;
+	t_compiled			compiled;
+	t_stage				stage[2];
+	int					staged;
+	t_encode			encode;
+	pthread_t			encoder;
+	int					encoding;
+}						t_reel;
+
+/* Checkpoint file: this header, the tile_done bitmap, the framebuffer */
+typedef struct s_checkpoint_header
+{
+	char				magic[8];
+	unsigned long		hash;
+	int					band_top;
+	int					samples;
+	int					tiles;
+}						t_checkpoint_header;
+
+typedef struct s_perf_counters
+{
+	int					fd[PERF_NUM_COUNTERS];
+	long long			value[PERF_NUM_COUNTERS];
+}						t_perf_counters;
 
 /* Function prototypes */
 void					draw_new_image(t_vars *vars, t_scene *scene);
 void					create_image(t_vars *vars);
 void					cleanup_image(t_vars *vars);
-void					main_draw(t_vars *vars, t_scene *scene);
 void					put_pixel(t_vars *vars, int x, int y, int color);
 void					cleanup_all(t_vars *vars);
 void					error_exit(char *message);
 void					print_scene_info(t_scene *scene);
+int						parse_options(int argc, char **argv, t_options *opts);
+void					render_apply_options(t_render *render,
+							const t_options *opts);
+void					options_camera(t_scene *scene, const t_options *opts);
+
+/* Window */
+void					window_start(t_vars *vars, t_scene *scene,
+							const t_options *opts);
+void					window_close(t_vars *vars);
+void					controls_changed(t_vars *vars, int what);
+int						controls_key(int keycode, t_vars *vars);
+int						controls_press(int button, int x, int y,
+							t_vars *vars);
+int						controls_release(int button, int x, int y,
+							t_vars *vars);
+int						controls_motion(int x, int y, t_vars *vars);
+void					controls_apply(t_vars *vars);
+int						controls_light_key(int keycode, t_vars *vars);
+void					controls_apply_light(t_vars *vars);
+
+/* Headless output */
+int						write_ppm(const char *path, const char *addr,
+							int width, int height);
+int						render_to_file(t_scene *scene, t_options *opts);
+void					pack_rgb(unsigned char *dst, const char *src,
+							int width);
+int						output_is_pfm(const char *path);
+int						render_streamed(t_scene *scene, t_options *opts);
+int						render_prepare(t_render *r, const t_scene *scene,
+							const t_options *opts, int height);
+void					render_release(t_render *r, const t_options *opts);
+
+/* Checkpoints */
+int						checkpoint_init(t_checkpoint *c, t_render *r,
+							const t_options *opts);
+int						checkpoint_load(t_checkpoint *c, t_render *r,
+							int kept);
+int						checkpoint_render(t_checkpoint *c, t_render *r,
+							t_farm *farm);
+int						checkpoint_band(t_checkpoint *c, t_render *r);
+void					checkpoint_finish(t_checkpoint *c, t_render *r,
+							int ok);
+
+/* Distributed rendering */
+int						farm_start(t_farm *farm, t_render *r,
+							const t_options *opts);
+int						farm_run(t_farm *farm, t_render *r);
+void					farm_stop(t_farm *farm);
+void					farm_worker(t_render *r, int fd);
+void					farm_tile(t_render *r, int tile, float *pixels,
+							int load);
+
+/* Render server */
+int						server_run(const t_options *opts);
+void					server_stop(t_server *server);
+void					server_request(t_server *server, char *line,
+							char *reply, size_t size);
+t_cached				*cache_acquire(t_server *server, char *path,
+							int *hit);
+void					cache_release(t_server *server, t_cached *entry);
+void					cache_clear(t_server *server);
+int						split_request(char *line, char **argv);
+int						request_options(int argc, char **argv,
+							t_options *opts);
+int						render_cached(const t_cached *entry,
+							t_options *opts);
+
+/* Job lists */
+int						jobs_run(const t_options *opts);
+
+/* Camera animation */
+int						animation_load(const char *path,
+							const t_scene *scene, t_animation *anim);
+void					animation_camera(const t_animation *anim,
+							double time, t_camera *camera);
+int						animate_run(t_scene *scene, const t_options *opts);
+
+/* File descriptors */
+int						write_full(int fd, const void *data, size_t n);
+int						read_full(int fd, void *data, size_t n);
+
+/* Benchmark */
+int						run_benchmark(t_scene *scene, t_options *opts);
+void					perf_counters_start(t_perf_counters *perf);
+void					perf_counters_stop(t_perf_counters *perf);
 
 
 /* Color utilities */
@@ -68,12 +565,12 @@ t_color3				clamp_color(t_color3 color);
 
 /* Lighting utilities */
 t_color3				calculate_ambient(const t_scene *scene,
-							const t_hit *hit);
-t_color3				calculate_diffuse(const t_scene *scene,
-							const t_hit *hit);
-int						is_in_shadow(const t_scene *scene, const t_vec3 point,
-							const t_vec3 light_pos);
-t_color3				calculate_lighting(const t_scene *scene,
-							const t_hit *hit);
+							const t_surface *surface);
+t_color3				calculate_diffuse(const t_compiled *compiled,
+							const t_surface *surface, int *visible);
+int						is_in_shadow(const t_compiled *compiled,
+							const t_vec3 point, const t_vec3 light_pos);
+t_color3				calculate_lighting(const t_compiled *compiled,
+							const t_surface *surface, int *visible);
 
 #endif
\ No newline at end of file
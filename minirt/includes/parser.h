@@ -1,16 +1,68 @@
 #ifndef PARSER_H
 # define PARSER_H
 
+# include "arena.h"
 # include "scene_math.h"
 
 
+/*
+** arena holds the current line's temporaries. stream, when set,
+** receives the parsed objects in batches so the BVH can be built while
+** parsing goes on. chunk is the parse chunk being read and pushed the
+** number of its objects already handed over.
+*/
 typedef struct s_parser
 {
-	char	*line;
-	char	**tokens;
-	int		line_count;
-	int		has_camera;
-}			t_parser;
+	char				*line;
+	char				**tokens;
+	int					line_count;
+	int					has_camera;
+	t_arena				*arena;
+	struct s_bvh_stream	*stream;
+	int					chunk;
+	int					pushed;
+}						t_parser;
+
+/* Files at least this large are parsed in parallel when threads = auto */
+# define PARSE_PARALLEL_MIN_SIZE 8388608
+# define MAX_PARSE_THREADS 64
+
+/*
+** Positions farther than this from the origin are warned about. In the
+** float build a camera this far out also becomes the scene's base.
+*/
+# define POSITION_FAR 1000.0
+
+/*
+** One newline-aligned slice of a mapped scene file. first_line is the
+** global number of the line just before the chunk, so a t_parser seeded
+** with it reports file-wide line numbers. error_line and the *_line
+** fields are 0 until the matching event happens. first_error is shared
+** by all chunks: the earliest failing line seen so far. index is the
+** chunk's position, which is also its id on the BVH stream. log holds
+** what the chunk's lines printed, log_len bytes of it, so the merge can
+** print it in file order. marks are the log lengths before the A, C and
+** L lines.
+*/
+typedef struct s_parse_chunk
+{
+	const char			*start;
+	const char			*end;
+	t_scene				scene;
+	int					first_line;
+	int					num_lines;
+	int					error_line;
+	int					ambient_line;
+	int					camera_line;
+	int					light_line;
+	int					*first_error;
+	struct s_bvh_stream	*stream;
+	int					index;
+	char				*log;
+	size_t				log_len;
+	size_t				log_size;
+	size_t				marks[3];
+}						t_parse_chunk;
 
 # define ERR_AMBIENT_FORMAT "Error: Invalid ambient lighting format\n"
 # define ERR_CAMERA_FORMAT "Error: Invalid camera format\n"
@@ -19,6 +71,9 @@ typedef struct s_parser
 # define ERR_PLANE_FORMAT "Error: Invalid plane format\n"
 # define ERR_CYLINDER_FORMAT "Error: Invalid cylinder format\n"
 # define ERR_CONE_FORMAT "Error: Invalid cone format\n"
+# define ERR_BOX_FORMAT "Error: Invalid box format\n"
+# define ERR_QUAD_FORMAT "Error: Invalid quad format\n"
+# define ERR_DISC_FORMAT "Error: Invalid disc format\n"
 # define ERR_UNKNOWN_ELEMENT "Error: Unknown element in scene file\n"
 # define ERR_DUPLICATE_ELEMENT "Error: Duplicate unique element in scene file\n"
 # define ERR_MISSING_ELEMENT "Error: Required element missing in scene file\n"
@@ -28,6 +83,7 @@ typedef struct s_parser
 # define ERR_FILE_EXTENSION "Error: File must have .rt extension\n"
 # define ERR_FILE_ACCESS "Error: Could not open file %s\n"
 # define ERR_UNKNOWN_IDENTIFIER "Error: Line %d: Unknown identifier '%s'\n"
+# define ERR_LINE_ELEMENT "Error: Line %d: Invalid '%s' element\n"
 # define ERR_MEMORY "Error: Memory allocation failed\n"
 
 /* Additional error messages for printf statements */
@@ -35,6 +91,7 @@ typedef struct s_parser
 # define ERR_AMBIENT_RATIO_RANGE "Error: Ambient ratio must be in [0.0, 1.0]\n"
 # define ERR_AMBIENT_COLOR_INVALID "Error: Invalid color for ambient lighting\n"
 # define ERR_AMBIENT_TOO_MANY_ARGS "Too many arguments for ambient\n"
+# define ERR_CAMERA_ALREADY_DEFINED "Error: Camera already defined\n"
 # define ERR_LIGHT_ALREADY_DEFINED "Error: Light source already defined\n"
 # define ERR_LIGHT_BRIGHTNESS_RANGE "Error: Light brightness in [0.0, 1.0]\n"
 # define ERR_LIGHT_COLOR_INVALID "Error: Invalid color for light source\n"
@@ -56,6 +113,9 @@ typedef struct s_parser
 # define ERR_CONE_TOO_MANY_ARGS "Too many arguments for cone\n"
 # define ERR_CONE_DIMS_POSITIVE "Cone angle and height must be positive\n"
 # define ERR_CONE_ANGLE_TOO_LARGE "Error: Cone angle must be <= 180 deg\n"
+# define ERR_BOX_SIZE_POSITIVE "Box width, height and depth must be positive\n"
+# define ERR_QUAD_SIZE_POSITIVE "Quad width and height must be positive\n"
+# define ERR_DISC_DIAMETER_POSITIVE "Disc diameter must be positive\n"
 # define ERR_CAMERA_FOV_RANGE "Camera FOV must be in [0, 180] degrees\n"
 # define ERR_SCENE_NO_CAMERA "Error: Camera not defined\n"
 # define ERR_SCENE_NO_AMBIENT "Error: Ambient lighting not defined\n"
@@ -74,7 +134,9 @@ typedef struct s_parser
 # define WARN_CYLINDER_DIMS_SMALL "Warning: Cylinder dimensions are very small\n"
 # define WARN_CONE_ANGLE_SMALL "Warning: Small cone angle (%.6f rad)\n"
 # define WARN_CONE_HEIGHT_SMALL "Warning: Small cone height (%.6f)\n"
-# define WARN_POSITION_FAR "Warning: %s far from origin (%.2f, %.2f, %.2f)\n"
+# define WARN_POSITION_FAR "Warning: %s far from the %s (%.2f, %.2f, %.2f)\n"
+# define WARN_POSITION_FLOAT "Warning: float build, expect precision loss \
+this far out (use PRECISION=double)\n"
 
 /* Format strings */
 # define FMT_AMBIENT_EXPECTED "Expected format: A ratio r,g,b\n"
@@ -83,15 +145,37 @@ typedef struct s_parser
 # define FMT_PLANE_EXPECTED "Expected format: pl x,y,z nx,ny,nz r,g,b\n"
 # define FMT_CYLINDER_EXPECTED "Expected: cy x,y,z nx,ny,nz diameter height r,g,b\n"
 # define FMT_CONE_EXPECTED "Expected format: cn x,y,z axis_x,y,z angle height r,g,b\n"
+# define FMT_BOX_EXPECTED "Expected format: bx x,y,z axis_x,y,z w,h,d r,g,b \
+[angle]\n"
+# define FMT_QUAD_EXPECTED "Expected format: qd x,y,z nx,ny,nz width height \
+r,g,b [angle]\n"
+# define FMT_DISC_EXPECTED "Expected format: dc x,y,z nx,ny,nz diameter r,g,b\n"
 # define FMT_CAMERA_EXPECTED "Expected format: C x,y,z nx,ny,nz fov\n"
 
 /* Function prototypes */
 /* File and scene loading */
-t_scene		*parse_scene_file(char *filename);
+t_scene		*parse_scene_file_threaded(char *filename, int num_threads);
+int			validate_extension_and_permission(const char *filename,
+				t_scene *scene);
+int			process_scene_line(t_parser *parser, t_scene *scene, char *line);
+void		stream_objects(t_parser *parser, t_scene *scene, int flush);
+
+/* Parallel parsing */
+void		chunk_split(t_parse_chunk *chunks, const char *map, size_t size,
+				int n);
+void		*chunk_count_lines(void *arg);
+void		*chunk_parse(void *arg);
+void		chunks_run(t_parse_chunk *chunks, int n, void *(*fn)(void *));
+void		parse_log_to(t_parse_chunk *chunk);
+void		parse_base_to(double *base);
+double		*parse_base(void);
+void		scene_find_base(const char *map, size_t size, double base[3]);
+int			parse_print(const char *format, ...);
 int			validate_scene(t_scene *scene);
 int			validate_scene_rendering(t_scene *scene);
 
 /* Element parsing functions */
+t_material	create_simple_material(t_color3 color);
 int			parse_ambient(char **tokens, t_scene *scene);
 int			parse_light(char **tokens, t_scene *scene);
 int			parse_camera(char **tokens, t_scene *scene);
@@ -99,9 +183,13 @@ int			parse_sphere(char **tokens, t_scene *scene);
 int			parse_plane(char **tokens, t_scene *scene);
 int			parse_cylinder(char **tokens, t_scene *scene);
 int			parse_cone(char **tokens, t_scene *scene);
+int			parse_box(char **tokens, t_scene *scene);
+int			parse_quad(char **tokens, t_scene *scene);
+int			parse_disc(char **tokens, t_scene *scene);
 
 /* Data type parsing */
 int			parse_vector(char *str, t_vec3 *vec);
+int			parse_position(char *str, t_vec3 *pos);
 int			parse_color(char *str, t_color3 *color);
 int			parse_double(char *str, double *value);
 
@@ -116,9 +204,11 @@ int			validate_sphere_diameter(double diameter);
 int			validate_cylinder_dimensions(double diameter, double height);
 int			validate_cone_dimensions(double angle, double height);
 int			validate_plane_normal(t_vec3 *normal);
-void		free_tokens(char **tokens);
+int			split_fields(char *str, const char *set, char **fields, int max);
+char		**split_line(t_arena *arena, char *line, const char *set);
 
 /* Scene management functions */
 int			add_object_to_scene(t_scene *scene, int type, void *object_data);
+void		free_scene(t_scene *scene);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,464 @@
+#ifndef RENDER_H
+# define RENDER_H
+
+# include "arena.h"
+# include "scene_math.h"
+# include <pthread.h>
+
+# define TILE_SIZE 32
+# define RT_EPSILON 1e-4
+# define MAX_RENDER_THREADS 64
+# define MAX_FOV_DEG 179.0
+
+/* Tile and in-tile pixel traversal orders */
+# define ORDER_ROW 0
+# define ORDER_MORTON 1
+# define ORDER_HILBERT 2
+
+/*
+** Camera basis derived from the parsed t_camera for a given resolution.
+** The view covers rows [top, top + height) of an image_height tall
+** image, all of it unless view_band narrowed it.
+*/
+typedef struct s_view
+{
+	t_point3		origin;
+	t_vec3			forward;
+	t_vec3			right;
+	t_vec3			up;
+	t_real			half_w;
+	t_real			half_h;
+	int				width;
+	int				height;
+	int				top;
+	int				image_height;
+}					t_view;
+
+typedef struct s_bsphere
+{
+	t_point3		center;
+	t_real			radius;
+}					t_bsphere;
+
+/* Type ids run from SPHERE to DISC, slot 0 is never used */
+# define PRIM_TYPES 8
+
+/*
+** Object index list sorted by type, the objects of type t being
+** items[runs[t]] to items[runs[t + 1] - 1]
+*/
+typedef struct s_span
+{
+	const int		*items;
+	int				count;
+	int				runs[PRIM_TYPES + 1];
+}					t_span;
+
+/*
+** Screen-space binning of finite objects, one candidate list per tile,
+** sorted by type. Lists are stored back to back in indices, the objects
+** of type k in tile t owning [offsets[t * PRIM_TYPES + k], the next
+** offset). Unbounded objects (planes, wide cones) are kept apart and
+** tested by every primary ray. total is the length of indices, known
+** even when there was no room for it.
+*/
+typedef struct s_tile_bins
+{
+	int				tiles_x;
+	int				tiles_y;
+	int				*offsets;
+	int				*indices;
+	int				total;
+	t_span			infinite;
+}					t_tile_bins;
+
+/*
+** Render-time object record holding only what intersection needs, one
+** cache line each. Spheres only touch the first 32 bytes.
+**   sphere    origin = center, k = radius^2
+**   plane     axis = unit normal
+**   cylinder  origin = center, axis, k = radius^2, extent = height / 2
+**   cone      origin = vertex, axis, k = cos^2(angle), extent = height
+**   box       origin = center, frame = unit side then unit axis, half
+**             = half width and depth along side and side x axis,
+**             extent = half height along axis
+**   quad      origin = center, frame = unit side then unit normal, half
+**             = half width and height along side and side x normal
+**   disc      origin = center, axis = unit normal, k = radius^2
+** Boxes and quads keep their frame in float to stay within the line,
+** prim_frame gives it back with the third vector.
+*/
+typedef struct s_prim
+{
+	t_point3		origin;
+	union
+	{
+		t_real		k;
+		float		half[2];
+	};
+	union
+	{
+		t_vec3		axis;
+		float		frame[2][3];
+	};
+	float			extent;
+	int				type;
+}	__attribute__((aligned(64)))	t_prim;
+
+/*
+** Shading data, only fetched for the winning hit, the color being the
+** material's. source is the index of the object in t_scene.
+*/
+typedef struct s_prim_cold
+{
+	t_material		material;
+	int				source;
+}					t_prim_cold;
+
+/* Bounding volume hierarchy */
+# define BVH_BATCH_SIZE 4096
+# define BVH_LEAF_SIZE 4
+# define BVH_STACK_SIZE 64
+# define BVH_MAX_CHUNKS 64
+# define MAX_BVH_BUILDERS 8
+
+/*
+** Inner nodes have count == 0 and two children, leaves own the range
+** [first, first + count) of t_bvh.items. Children are not necessarily
+** adjacent since treelets are built separately and linked at the end.
+*/
+typedef struct s_bvh_node
+{
+	t_vec3			lo;
+	t_vec3			hi;
+	int				left;
+	int				right;
+	int				first;
+	int				count;
+}					t_bvh_node;
+
+/*
+** Object-index BVH over the bounded objects of a scene. Unbounded ones
+** (planes, wide cones) sit in a flat list next to it. root is -1 when
+** no object is bounded.
+*/
+typedef struct s_bvh
+{
+	t_bvh_node		*nodes;
+	int				*items;
+	int				*unbounded;
+	int				num_nodes;
+	int				num_items;
+	int				num_unbounded;
+	int				root;
+}					t_bvh;
+
+/*
+** A run of consecutive objects from one parse chunk, copied out of the
+** parser so it can keep growing its array. A builder turns it into a
+** treelet whose items and unbounded entries are batch-local indices.
+*/
+typedef struct s_bvh_batch
+{
+	struct s_bvh_batch	*next;
+	t_object			*objects;
+	int					count;
+	int					chunk;
+	int					first;
+	t_bvh_node			*nodes;
+	int					*items;
+	int					*unbounded;
+	int					num_nodes;
+	int					num_items;
+	int					num_unbounded;
+}						t_bvh_batch;
+
+/*
+** Producer/consumer queue between the parser and the builder threads.
+** chunk_count tracks how many objects each parse chunk has pushed so
+** far, chunk_base is set once the chunk's place in the scene is known.
+*/
+typedef struct s_bvh_stream
+{
+	pthread_mutex_t	lock;
+	pthread_cond_t	ready;
+	t_bvh_batch		*head;
+	t_bvh_batch		*tail;
+	t_bvh_batch		*done;
+	int				closed;
+	int				failed;
+	pthread_t		threads[MAX_BVH_BUILDERS];
+	int				num_threads;
+	int				chunk_count[BVH_MAX_CHUNKS];
+	int				chunk_base[BVH_MAX_CHUNKS];
+}					t_bvh_stream;
+
+/*
+** Parallel hot and cold arrays compiled from a t_scene. bvh is the
+** scene's own hierarchy, NULL when none was built. all lists every
+** object by type, types has bit 1 << type set for each type present.
+*/
+typedef struct s_compiled
+{
+	const t_scene	*scene;
+	const t_bvh		*bvh;
+	t_prim			*prims;
+	t_prim_cold		*cold;
+	int				count;
+	int				*order;
+	t_span			all;
+	int				types;
+}					t_compiled;
+
+/* Intersection kernel: distance along the ray or -1, and the part hit */
+typedef t_real		(*t_kernel)(const t_prim *prim, const t_ray *ray,
+						int *part);
+
+/*
+** Sub-part of a primitive reported by the intersection kernels. Boxes
+** report the face instead: 0, 1 or 2 for the first frame vector, the
+** axis or the second frame vector it is perpendicular to.
+*/
+# define PART_SIDE 0
+# define PART_CAP_TOP 1
+# define PART_CAP_BOTTOM 2
+
+/*
+** Minimal record kept while searching for the closest hit. Everything
+** else is reconstructed once, for the winner, into a t_surface.
+*/
+typedef struct s_hit
+{
+	t_real			t;
+	int				index;
+	int				part;
+}					t_hit;
+
+/*
+** G-buffer entry: the primary hit of a pixel, whether its point sees
+** the light (-1 while unknown) and how many frames ago it was last
+** traced rather than reprojected
+*/
+typedef struct s_gsample
+{
+	t_hit			hit;
+	int				visible;
+	int				age;
+}					t_gsample;
+
+/* Frames shaded from the G-buffer: with new shadow rays, or none */
+# define RELIGHT_OFF 0
+# define RELIGHT_SHADE 1
+# define RELIGHT_SHADOWS 2
+
+/*
+** Reprojection: a pixel is traced again once its hit is HISTORY_AGE
+** frames old, and every HISTORY_AGE-th pixel of a diagonal pattern that
+** moves each frame is, so the refresh is spread over frames. A reused
+** hit must land within REPROJECT_DEPTH of the reprojected depth, and no
+** neighbor may be REPROJECT_EDGE nearer, both relative. SPLAT_NONE marks
+** a pixel no history pixel landed on.
+*/
+# define HISTORY_AGE 8
+# define REPROJECT_DEPTH 0.01
+# define REPROJECT_EDGE 0.05
+# define SPLAT_NONE 0xFFFFFFFFFFFFFFFFUL
+
+typedef struct s_surface
+{
+	t_point3		point;
+	t_vec3			normal;
+	t_real			u;
+	t_real			v;
+	t_color3		albedo;
+	t_material		material;
+}					t_surface;
+
+/* Transfer curves of the resolve pass */
+# define TRANSFER_LINEAR 0
+# define TRANSFER_SRGB 1
+# define RESOLVE_ROWS 16
+
+/*
+** Linear RGB accumulation buffer, one float plane per channel. A frame
+** rendered while samples > 0 adds to it instead of overwriting it. The
+** resolve pass divides by samples, applies exposure and the transfer
+** curve, dithers (sRGB only) and packs the result into the image.
+*/
+typedef struct s_framebuffer
+{
+	float			*plane[3];
+	int				width;
+	int				height;
+	int				samples;
+	float			exposure;
+	int				transfer;
+}					t_framebuffer;
+
+/* Event loop pause while no tile is ready */
+# define RENDER_POLL_US 2000
+
+/*
+** Background frame for the window. Workers resolve each finished tile
+** into the back buffer (render.addr) and publish it: a slot claimed from
+** tail holds tile + 1 once the tile is complete. Only the event loop
+** reads, from head, copying published tiles into the front image, so a
+** tile is never shown half-written. A restart cancels the frame; the
+** event loop polls until the workers have left, edits the scene if it
+** has to and starts the next one.
+*/
+typedef struct s_async
+{
+	pthread_t		threads[MAX_RENDER_THREADS];
+	int				started;
+	int				*ready;
+	int				total;
+	int				tail;
+	int				head;
+	int				running;
+	int				cancel;
+	int				restart;
+	int				finished;
+	char			*front;
+}					t_async;
+
+typedef struct s_render
+{
+	const t_scene	*scene;
+	t_compiled		compiled;
+	t_view			view;
+	t_tile_bins		bins;
+	t_framebuffer	fb;
+	t_async			async;
+	int				accumulate;
+	int				preview;
+	t_gsample		*gbuffer;
+	t_gsample		*history;
+	t_view			history_view;
+	int				has_history;
+	int				relight;
+	int				reproject;
+	unsigned long	*splat;
+	unsigned int	frames;
+	char			*addr;
+	int				line_length;
+	int				bytes_per_pixel;
+	int				endian;
+	int				image_height;
+	int				band_top;
+	int				num_threads;
+	int				next_tile;
+	int				tile_limit;
+	unsigned char	*tile_done;
+	int				next_row;
+	int				order;
+	int				*tile_order;
+	t_arena			frame;
+	unsigned short	pixel_order[TILE_SIZE * TILE_SIZE];
+}					t_render;
+
+/* Camera */
+void				view_setup(t_view *view, const t_camera *camera,
+						int width, int height);
+t_ray				view_ray(const t_view *view, t_real px, t_real py);
+void				view_band(t_view *view, int top, int rows);
+
+/* Compiled scene */
+int					compile_scene(t_compiled *compiled, const t_scene *scene);
+void				compiled_free(t_compiled *compiled);
+void				compile_object(t_compiled *compiled, int index);
+
+/* Intersection */
+t_real				hit_sphere(const t_prim *sphere, const t_ray *ray,
+						int *part);
+t_real				hit_plane(const t_prim *plane, const t_ray *ray,
+						int *part);
+t_real				hit_cylinder(const t_prim *cylinder, const t_ray *ray,
+						int *part);
+t_real				hit_cone(const t_prim *cone, const t_ray *ray, int *part);
+void				prim_frame(const t_prim *prim, t_vec3 frame[3]);
+t_real				hit_box(const t_prim *box, const t_ray *ray, int *part);
+t_real				hit_quad(const t_prim *quad, const t_ray *ray, int *part);
+t_real				hit_disc(const t_prim *disc, const t_ray *ray, int *part);
+t_real				prim_hit(const t_prim *prim, const t_ray *ray, int *part);
+void				span_by_type(t_span *span, const t_object *objects,
+						const int *items, int *out);
+void				closest_in_span(const t_compiled *compiled, t_span span,
+						const t_ray *ray, t_hit *hit);
+
+/* Hit reconstruction */
+t_vec3				prim_normal(const t_prim *prim, t_point3 point, int part);
+void				surface_from_hit(const t_compiled *compiled,
+						const t_ray *ray, const t_hit *hit,
+						t_surface *surface);
+t_color3			shade_hit(const t_compiled *compiled, const t_ray *ray,
+						const t_hit *hit, int *visible);
+t_color3			sky_color(const t_ray *ray);
+
+/* Framebuffer */
+int					framebuffer_init(t_framebuffer *fb, int width, int height);
+void				framebuffer_free(t_framebuffer *fb);
+void				framebuffer_resolve(const t_framebuffer *fb,
+						const t_render *render, const int rect[4]);
+
+/* Tile binning */
+int					object_bounds(const t_object *object, t_bsphere *bounds);
+int					tile_bins_build(t_tile_bins *bins, const t_scene *scene,
+						const t_view *view, t_arena *frame);
+t_span				tile_bins_span(const t_tile_bins *bins, int tile);
+
+/* Bounding volume hierarchy */
+int					bvh_build_batch(t_bvh_batch *batch, t_arena *scratch);
+int					bvh_build_top(t_bvh *bvh, int *roots, int count,
+						t_arena *scratch);
+int					bvh_morton_sort(unsigned int *codes, int *items, int n,
+						t_arena *scratch);
+void				bvh_refit(t_bvh *bvh, const t_object *objects);
+t_bvh_stream		*bvh_stream_start(void);
+void				bvh_stream_push(t_bvh_stream *stream, int chunk,
+						const t_object *objects, int count);
+void				bvh_stream_place(t_bvh_stream *stream, int chunk,
+						int first);
+t_bvh				*bvh_stream_finish(t_bvh_stream *stream);
+t_bvh				*bvh_assemble(const t_bvh_stream *stream);
+void				bvh_free_batch(t_bvh_batch *batch);
+int					bvh_occluded(const t_compiled *compiled,
+						const t_ray *ray, t_real max_t);
+void				bvh_free(t_bvh *bvh);
+
+/* Traversal order */
+int					curve_order(int order, int width, int height, int *out);
+int					traversal_build(t_render *render);
+const char			*order_name(int order);
+
+/* Rendering */
+int					render_setup(t_render *render, const t_scene *scene,
+						int width, int height);
+int					render_init(t_render *render, const t_scene *scene,
+						int width, int height);
+void				render_destroy(t_render *render);
+int					render_scene(t_render *render);
+int					render_frame_begin(t_render *render);
+void				render_resolve(t_render *render);
+int					render_gbuffer_init(t_render *render);
+void				render_commit(t_render *render);
+void				render_run_workers(t_render *render,
+						void *(*worker)(void *));
+void				render_tile(t_render *render, int tile);
+void				*render_worker(void *render);
+
+/* Background rendering */
+int					render_async_start(t_render *render);
+void				render_publish(t_render *render, int tile);
+int					render_async_present(t_render *render);
+int					render_async_idle(t_render *render);
+int					render_async_finished(t_render *render);
+void				render_async_restart(t_render *render);
+void				render_async_stop(t_render *render);
+
+/* Temporal reprojection */
+int					reproject_begin(t_render *render);
+int					reproject_pixel(t_render *render, const t_ray *ray,
+						size_t p, t_gsample *out);
+
+#endif
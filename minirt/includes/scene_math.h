@@ -4,20 +4,52 @@
 # include <math.h>
 # include <stdio.h>
 
+/*
+** Scalar type of the vector, matrix and intersection code. Build with
+** RT_FLOAT defined (make PRECISION=float) for the single-precision
+** path. Quadratic discriminants and the squared ray-to-object offsets
+** that feed them stay in double in both builds.
+*/
+# ifdef RT_FLOAT
+
+typedef float		t_real;
+#  define RT_SQRT sqrtf
+# else
+
+typedef double		t_real;
+#  define RT_SQRT sqrt
+# endif
+
 typedef struct s_vec3
 {
-	double			x;
-	double			y;
-	double			z;
+	t_real			x;
+	t_real			y;
+	t_real			z;
 }					t_vec3;
 
 typedef struct s_quadratic
 {
-	double			a;
-	double			b;
-	double			c;
+	t_real			a;
+	t_real			b;
+	t_real			c;
 }					t_quadratic;
 
+/*
+** Up to QUADRATIC_LANES equations a t^2 + 2 half_b t + c = 0 solved side
+** by side, structure of arrays so the solver loop vectorizes. t receives
+** the nearest root of each lane, see solve_quadratic_batch.
+*/
+# define QUADRATIC_LANES 8
+
+typedef struct s_quadratics
+{
+	double			a[QUADRATIC_LANES];
+	double			half_b[QUADRATIC_LANES];
+	double			c[QUADRATIC_LANES];
+	double			t[QUADRATIC_LANES];
+	int				count;
+}					t_quadratics;
+
 typedef t_vec3		t_point3;
 typedef t_vec3		t_color3;
 
@@ -25,25 +57,28 @@ typedef t_vec3		t_color3;
 # define PLANE 2
 # define CYLINDER 3
 # define CONE 4
-# define MAX_OBJECTS 100
+# define BOX 5
+# define QUAD 6
+# define DISC 7
+# define OBJECTS_INITIAL_CAPACITY 64
 
 typedef struct s_camera
 {
 	t_point3		position;
 	t_vec3			orientation;
-	double			fov;
+	t_real			fov;
 }					t_camera;
 
 typedef struct s_ambient
 {
-	double			ratio;
+	t_real			ratio;
 	t_vec3		    color;
 }					t_ambient;
 
 typedef struct s_light
 {
 	t_point3		position;
-	double			brightness;
+	t_real			brightness;
 	t_vec3		    color;
 }					t_light;
 
@@ -55,7 +90,7 @@ typedef struct s_material
 typedef struct s_sphere
 {
 	t_point3		center;
-	double			diameter;
+	t_real			diameter;
 	t_vec3		    color;
 	t_material		material;
 }					t_sphere;
@@ -72,8 +107,8 @@ typedef struct s_cylinder
 {
 	t_point3		center;
 	t_vec3			axis;
-	double			diameter;
-	double			height;
+	t_real			diameter;
+	t_real			height;
 	t_vec3		    color;
 	t_material		material;
 }					t_cylinder;
@@ -82,12 +117,52 @@ typedef struct s_cone
 {
 	t_point3		vertex;
 	t_vec3			axis;
-	double			angle;
-	double			height;
+	t_real			angle;
+	t_real			height;
 	t_vec3		    color;
 	t_material		material;
 }					t_cone;
 
+/*
+** Box centered on center. size holds the full extents along side, then
+** along axis, then along their cross product. side is a unit vector
+** perpendicular to axis: with axis 0,1,0 and no turn that is width x,
+** height y and depth z.
+*/
+typedef struct s_box
+{
+	t_point3		center;
+	t_vec3			axis;
+	t_vec3			side;
+	t_vec3			size;
+	t_vec3		    color;
+	t_material		material;
+}					t_box;
+
+/*
+** Rectangle centered on center, width along side, a unit vector in its
+** plane, and height along the cross product of side and normal
+*/
+typedef struct s_quad
+{
+	t_point3		center;
+	t_vec3			normal;
+	t_vec3			side;
+	t_real			width;
+	t_real			height;
+	t_vec3		    color;
+	t_material		material;
+}					t_quad;
+
+typedef struct s_disc
+{
+	t_point3		center;
+	t_vec3			normal;
+	t_real			diameter;
+	t_vec3		    color;
+	t_material		material;
+}					t_disc;
+
 typedef struct s_object
 {
 	int				type;
@@ -97,23 +172,35 @@ typedef struct s_object
 		t_plane		plane;
 		t_cylinder	cylinder;
 		t_cone		cone;
+		t_box		box;
+		t_quad		quad;
+		t_disc		disc;
 	} data;
 }					t_object;
 
+/*
+** Coordinates are relative to base, the world point at the scene's origin.
+** base is zero unless the float build moved it to a far camera, see
+** scene_find_base.
+*/
 typedef struct s_scene
 {
 	t_camera		camera;
 	t_ambient		ambient;
 	t_light			light;
-	t_object		objects[MAX_OBJECTS];
+	t_object		*objects;
 	int				num_objects;
+	int				capacity;
 	int				has_ambient;
+	int				has_camera;
 	int				has_light;
+	struct s_bvh	*bvh;
+	double			base[3];
 }					t_scene;
 
 typedef struct s_matrix4
 {
-	double			m[4][4];
+	t_real			m[4][4];
 }					t_matrix4;
 
 typedef struct s_transform
@@ -132,28 +219,34 @@ typedef struct s_ray
 }					t_ray;
 
 // --- Math/vector utilities ---
-t_vec3				vec3_create(double x, double y, double z);
+t_vec3				vec3_create(t_real x, t_real y, t_real z);
 t_vec3				vec3_add(t_vec3 v1, t_vec3 v2);
 t_vec3				vec3_sub(t_vec3 v1, t_vec3 v2);
-t_vec3				vec3_mult(t_vec3 v, double t);
-t_vec3				vec3_div(t_vec3 v, double t);
+t_vec3				vec3_mult(t_vec3 v, t_real t);
+t_vec3				vec3_div(t_vec3 v, t_real t);
 t_vec3				vec3_cross(t_vec3 v1, t_vec3 v2);
 t_vec3				vec3_normalize(t_vec3 v);
-double				vec3_dot(t_vec3 v1, t_vec3 v2);
-double				vec3_length(t_vec3 v);
-double				vec3_length_squared(t_vec3 v);
+t_real				vec3_dot(t_vec3 v1, t_vec3 v2);
+t_real				vec3_length(t_vec3 v);
+t_real				vec3_length_squared(t_vec3 v);
 t_vec3				reflect(t_vec3 v, t_vec3 n);
 t_vec3				vec3_rotate_around_axis(t_vec3 v, t_vec3 axis,
-						double angle);
-double				solve_quadratic(double a, double b, double c, double min_t);
+						t_real angle);
+double				solve_quadratic(double a, double half_b, double c,
+						double min_t);
+int					solve_quadratic_roots(double a, double half_b, double c,
+						double roots[2]);
+void				solve_quadratic_batch(t_quadratics *batch, double min_t);
+double				vec3_dot_wide(t_vec3 v1, t_vec3 v2);
+void				vec3_frame(t_vec3 axis, t_vec3 *e1, t_vec3 *e2);
 
 // --- Matrix operations ---
 t_matrix4			matrix4_identity(void);
 t_matrix4			matrix4_multiply(t_matrix4 a, t_matrix4 b);
 t_matrix4			matrix4_translation(t_vec3 translation);
-t_matrix4			matrix4_rotation_x(double angle);
-t_matrix4			matrix4_rotation_y(double angle);
-t_matrix4			matrix4_rotation_z(double angle);
+t_matrix4			matrix4_rotation_x(t_real angle);
+t_matrix4			matrix4_rotation_y(t_real angle);
+t_matrix4			matrix4_rotation_z(t_real angle);
 t_matrix4			matrix4_scale(t_vec3 scale);
 t_vec3				matrix4_transform_point(t_matrix4 m, t_vec3 point);
 t_vec3				matrix4_transform_direction(t_matrix4 m, t_vec3 direction);
@@ -165,7 +258,7 @@ void				transform_translate(t_transform *transform,
 						t_vec3 translation);
 void				transform_rotate(t_transform *transform, t_vec3 rotation);
 void				transform_scale_uniform(t_transform *transform,
-						double scale);
+						t_real scale);
 void				transform_scale(t_transform *transform, t_vec3 scale);
 
 // --- Object transformation ---
@@ -174,6 +267,9 @@ void				transform_plane(t_plane *plane, t_transform *transform);
 void				transform_cylinder(t_cylinder *cylinder,
 						t_transform *transform);
 void				transform_cone(t_cone *cone, t_transform *transform);
+void				transform_box(t_box *box, t_transform *transform);
+void				transform_quad(t_quad *quad, t_transform *transform);
+void				transform_disc(t_disc *disc, t_transform *transform);
 void				transform_camera(t_camera *camera, t_transform *transform);
 
 // --- Scene transformation utilities ---
@@ -182,9 +278,10 @@ void				scene_translate_object(t_scene *scene, int obj_index,
 void				scene_rotate_object(t_scene *scene, int obj_index,
 						t_vec3 rotation);
 void				scene_scale_object(t_scene *scene, int obj_index,
-						double scale);
+						t_real scale);
 void				scene_translate_camera(t_scene *scene, t_vec3 delta);
 void				scene_rotate_camera(t_scene *scene, t_vec3 rotation);
+t_vec3				scene_rebase(const t_scene *scene, t_vec3 world);
 
 // --- Ray tracing functions ---
 t_ray				generate_camera_ray(const t_scene *scene, int x, int y);
@@ -0,0 +1,206 @@
+#include "../../includes/minirt_app.h"
+#include <time.h>
+
+static double	now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6);
+}
+
+/* Write a frame as its numbered file: out.ppm gives out_0000.ppm on */
+static void	*encode(void *arg)
+{
+	t_encode	*e;
+	const char	*extension;
+	char		path[PATH_MAX];
+
+	e = (t_encode *)arg;
+	extension = ft_strrchr(e->opts->output, '.');
+	if (!extension || ft_strchr(extension, '/'))
+		snprintf(path, sizeof(path), "%s_%04d", e->opts->output, e->frame);
+	else
+		snprintf(path, sizeof(path), "%.*s_%04d%s",
+			(int)(extension - e->opts->output), e->opts->output, e->frame,
+			extension);
+	e->ok = write_ppm(path, e->addr, e->opts->width, e->opts->height);
+	return (NULL);
+}
+
+/* Set up the frame a stage was given, its tile bins and traversal */
+static void	*prepare(void *arg)
+{
+	t_stage	*s;
+
+	s = (t_stage *)arg;
+	s->ok = render_frame_begin(&s->render);
+	return (NULL);
+}
+
+/*
+** Give a stage frame f: its time spreads the frames evenly from the
+** first key to the last, the camera follows
+*/
+static void	stage_camera(t_reel *reel, t_stage *s, int f)
+{
+	const t_keyframe	*k;
+	double				time;
+
+	k = reel->anim.keys;
+	time = k[0].time;
+	if (reel->frames > 1)
+		time += (k[reel->anim.count - 1].time - k[0].time) * f
+			/ (reel->frames - 1);
+	animation_camera(&reel->anim, time, &s->scene.camera);
+}
+
+/*
+** Wait for the frame being encoded, if any, then hand it the one just
+** rendered, written on the spot when its thread does not start
+*/
+static int	reel_encode(t_reel *reel, const t_stage *s, int f)
+{
+	int	ok;
+
+	ok = TRUE;
+	if (reel->encoding)
+		pthread_join(reel->encoder, NULL);
+	if (reel->encoding)
+		ok = reel->encode.ok;
+	reel->encoding = FALSE;
+	if (!s)
+		return (ok);
+	reel->encode.addr = s->render.addr;
+	reel->encode.frame = f;
+	if (pthread_create(&reel->encoder, NULL, encode, &reel->encode) == 0)
+		reel->encoding = TRUE;
+	else
+		encode(&reel->encode);
+	if (!reel->encoding)
+		ok = ok && reel->encode.ok;
+	return (ok);
+}
+
+/*
+** Render frame f, already set up, while a thread sets up the next one
+** in the other stage. The previous frame is written from that stage's
+** image meanwhile, so the frame after next may render into it.
+*/
+static int	reel_frame(t_reel *reel, int f)
+{
+	t_stage		*s;
+	t_stage		*next;
+	pthread_t	thread;
+	int			preparing;
+
+	s = &reel->stage[f % 2];
+	next = &reel->stage[(f + 1) % 2];
+	preparing = FALSE;
+	next->ok = TRUE;
+	if (f + 1 < reel->frames)
+	{
+		stage_camera(reel, next, f + 1);
+		preparing = (pthread_create(&thread, NULL, prepare, next) == 0);
+	}
+	render_run_workers(&s->render, render_worker);
+	render_resolve(&s->render);
+	if (preparing)
+		pthread_join(thread, NULL);
+	else if (f + 1 < reel->frames)
+		prepare(next);
+	return (reel_encode(reel, s, f) && next->ok);
+}
+
+/* --frames, or ANIMATION_FPS frames a second from the first key on */
+static int	reel_frames(const t_animation *anim, const t_options *opts)
+{
+	double	frames;
+
+	if (opts->frames)
+		return (opts->frames);
+	frames = (anim->keys[anim->count - 1].time - anim->keys[0].time)
+		* ANIMATION_FPS + 1;
+	if (frames > MAX_FRAMES)
+		return (MAX_FRAMES);
+	return ((int)frames);
+}
+
+/*
+** Load the keyframes, set up both stages on the scene compiled once,
+** opts sharing it, and frame 0 in the first
+*/
+static int	reel_setup(t_reel *reel, const t_scene *scene,
+		const t_options *opts)
+{
+	t_stage	*s;
+
+	if (!animation_load(opts->animate, scene, &reel->anim))
+		return (FALSE);
+	reel->frames = reel_frames(&reel->anim, opts);
+	if (!compile_scene(&reel->compiled, scene))
+		return (printf(ERR_MEMORY), FALSE);
+	while (reel->staged < 2)
+	{
+		s = &reel->stage[reel->staged];
+		s->scene = *scene;
+		if (!render_prepare(&s->render, &s->scene, opts, opts->height))
+			return (printf(ERR_MEMORY), FALSE);
+		render_apply_options(&s->render, opts);
+		s->render.line_length = opts->width * 4;
+		s->render.bytes_per_pixel = 4;
+		s->render.addr = malloc((size_t)opts->width * opts->height * 4);
+		reel->staged++;
+		if (!s->render.addr)
+			return (printf(ERR_MEMORY), FALSE);
+	}
+	stage_camera(reel, &reel->stage[0], 0);
+	prepare(&reel->stage[0]);
+	return (reel->stage[0].ok);
+}
+
+static void	reel_free(t_reel *reel, const t_options *opts)
+{
+	while (reel->staged-- > 0)
+	{
+		free(reel->stage[reel->staged].render.addr);
+		render_release(&reel->stage[reel->staged].render, opts);
+	}
+	compiled_free(&reel->compiled);
+	free(reel->anim.keys);
+}
+
+/*
+** Camera animation: the scene is parsed, built and compiled once, each
+** frame only moves the camera, bins its view and traces its rays. Two
+** stages take turns so a frame sets up while the one before renders,
+** and an encoder thread writes each frame while the next renders.
+*/
+int	animate_run(t_scene *scene, const t_options *opts)
+{
+	t_reel		reel;
+	t_options	shared;
+	double		start;
+	int			ok;
+	int			f;
+
+	if (!opts->output || output_is_pfm(opts->output) || opts->max_memory
+		|| opts->checkpoint || opts->workers)
+		return (printf(ERR_ANIMATE), FALSE);
+	ft_bzero(&reel, sizeof(t_reel));
+	shared = *opts;
+	shared.compiled = &reel.compiled;
+	reel.encode.opts = opts;
+	start = now_ms();
+	ok = reel_setup(&reel, scene, &shared);
+	f = -1;
+	while (ok && ++f < reel.frames)
+		ok = reel_frame(&reel, f);
+	ok = reel_encode(&reel, NULL, 0) && ok;
+	start = now_ms() - start;
+	if (ok)
+		printf("%d frames in %.2f s, %.2f frames/s\n", reel.frames,
+			start / 1000.0, reel.frames * 1000.0 / start);
+	reel_free(&reel, &shared);
+	return (ok);
+}
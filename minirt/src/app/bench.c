@@ -0,0 +1,136 @@
+#include "../../includes/minirt_app.h"
+#include <time.h>
+
+static double	now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6);
+}
+
+static void	print_counter(long long value, long long base)
+{
+	if (value < 0)
+		printf(" %14s %9s", "n/a", "");
+	else if (base <= 0)
+		printf(" %14lld %9s", value, "");
+	else
+		printf(" %14lld %+8.1f%%", value, 100.0 * (value - base) / base);
+}
+
+static void	bench_order(t_render *render, int order, long long *base)
+{
+	t_perf_counters	perf;
+	double			start;
+	int				i;
+
+	render->order = order;
+	perf_counters_start(&perf);
+	start = now_ms();
+	render_scene(render);
+	start = now_ms() - start;
+	perf_counters_stop(&perf);
+	printf("%-8s %10.2f", order_name(order), start);
+	i = -1;
+	while (++i < PERF_NUM_COUNTERS)
+	{
+		print_counter(perf.value[i], base[i]);
+		if (order == ORDER_ROW)
+			base[i] = perf.value[i];
+	}
+	printf("\n");
+}
+
+static double	timed_frame(t_render *render, int relight)
+{
+	double	start;
+
+	render->relight = relight;
+	start = now_ms();
+	render_scene(render);
+	start = now_ms() - start;
+	render->relight = RELIGHT_OFF;
+	return (start);
+}
+
+/*
+** A traced frame that fills the G-buffer, then the same frame shaded
+** from it as the window does after a light move, and after a color or
+** brightness edit
+*/
+static void	bench_relight(t_render *render)
+{
+	double	traced;
+	double	relit;
+
+	if (!render_gbuffer_init(render))
+		return ;
+	traced = timed_frame(render, RELIGHT_OFF);
+	render_commit(render);
+	relit = timed_frame(render, RELIGHT_SHADOWS);
+	printf("%-8s %10.2f  (traced %.2f, x%.1f)\n", "relight", relit, traced,
+		traced / relit);
+	relit = timed_frame(render, RELIGHT_SHADE);
+	printf("%-8s %10.2f  (traced %.2f, x%.1f)\n", "reshade", relit, traced,
+		traced / relit);
+}
+
+/*
+** The committed frame after one arrow key turn of the camera,
+** reprojected, then traced in full at the new angle
+*/
+static void	bench_reproject(t_render *render, t_scene *scene)
+{
+	t_camera	saved;
+	double		reused;
+	double		traced;
+
+	if (!render->has_history)
+		return ;
+	saved = scene->camera;
+	scene->camera.orientation = vec3_rotate_around_axis(
+			vec3_normalize(saved.orientation), vec3_create(0, 1, 0), TURN_STEP);
+	render->reproject = TRUE;
+	reused = timed_frame(render, RELIGHT_OFF);
+	render->reproject = FALSE;
+	traced = timed_frame(render, RELIGHT_OFF);
+	scene->camera = saved;
+	printf("%-8s %10.2f  (traced %.2f, x%.1f)\n", "reproj", reused, traced,
+		traced / reused);
+}
+
+/*
+** Headless render of the scene once per traversal order. Cache counters
+** are reported next to their change relative to row-major order. The
+** last lines time relighting from the G-buffer and reprojecting it.
+*/
+int	run_benchmark(t_scene *scene, t_options *opts)
+{
+	t_render	render;
+	long long	base[PERF_NUM_COUNTERS];
+
+	if (!render_init(&render, scene, opts->width, opts->height))
+		return (printf(ERR_MEMORY), FALSE);
+	render_apply_options(&render, opts);
+	render.line_length = opts->width * 4;
+	render.bytes_per_pixel = 4;
+	render.addr = malloc((size_t)opts->width * opts->height * 4);
+	if (!render.addr)
+		return (render_destroy(&render), printf(ERR_MEMORY), FALSE);
+	printf("bench: %s %dx%d, %d objects, %d threads, %dpx tiles\n",
+		opts->scene_path, opts->width, opts->height, scene->num_objects,
+		render.num_threads, TILE_SIZE);
+	render_scene(&render);
+	printf("%-8s %10s %14s %9s %14s %9s %14s %9s\n", "order", "time(ms)",
+		"cache-refs", "", "cache-misses", "", "l1d-misses", "");
+	ft_bzero(base, sizeof(base));
+	bench_order(&render, ORDER_ROW, base);
+	bench_order(&render, ORDER_MORTON, base);
+	bench_order(&render, ORDER_HILBERT, base);
+	bench_relight(&render);
+	bench_reproject(&render, scene);
+	free(render.addr);
+	render_destroy(&render);
+	return (TRUE);
+}
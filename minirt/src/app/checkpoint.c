@@ -0,0 +1,227 @@
+#include "../../includes/minirt_app.h"
+#include <time.h>
+
+static unsigned long	fnv(unsigned long hash, const void *data, size_t n)
+{
+	const unsigned char	*p;
+
+	p = data;
+	while (n-- > 0)
+		hash = (hash ^ *p++) * 0x100000001B3UL;
+	return (hash);
+}
+
+/* Every option shaping the output, band height and camera included */
+static unsigned long	options_hash(unsigned long hash, const t_options *opts,
+		int rows)
+{
+	int	shape[6];
+
+	shape[0] = opts->width;
+	shape[1] = opts->height;
+	shape[2] = rows;
+	shape[3] = opts->transfer;
+	shape[4] = output_is_pfm(opts->output);
+	shape[5] = opts->camera;
+	hash = fnv(hash, shape, sizeof(shape));
+	hash = fnv(hash, &opts->exposure, sizeof(opts->exposure));
+	if (opts->camera & OVERRIDE_POSITION)
+		hash = fnv(hash, &opts->camera_position, sizeof(t_vec3));
+	if (opts->camera & OVERRIDE_DIRECTION)
+		hash = fnv(hash, &opts->camera_direction, sizeof(t_vec3));
+	if (opts->camera & OVERRIDE_FOV)
+		hash = fnv(hash, &opts->fov, sizeof(opts->fov));
+	return (hash);
+}
+
+/*
+** Identity of a render: the bytes of the scene file and the options
+** shaping the output, through 64-bit FNV-1a
+*/
+static int	render_hash(const t_options *opts, int rows, unsigned long *hash)
+{
+	char	buffer[4096];
+	ssize_t	n;
+	int		fd;
+
+	fd = open(opts->scene_path, O_RDONLY);
+	if (fd < 0)
+		return (FALSE);
+	*hash = 0xCBF29CE484222325UL;
+	n = read(fd, buffer, sizeof(buffer));
+	while (n > 0)
+	{
+		*hash = fnv(*hash, buffer, n);
+		n = read(fd, buffer, sizeof(buffer));
+	}
+	close(fd);
+	*hash = options_hash(*hash, opts, rows);
+	return (n == 0);
+}
+
+/*
+** Set up checkpoints when asked for: a tile_done map for the render's
+** band and the hash saves are checked against. No path means no
+** checkpoints.
+*/
+int	checkpoint_init(t_checkpoint *c, t_render *r, const t_options *opts)
+{
+	ft_bzero(c, sizeof(t_checkpoint));
+	if (!opts->checkpoint)
+		return (TRUE);
+	c->period = opts->checkpoint;
+	c->resume = opts->resume;
+	c->saved = time(NULL);
+	c->tiles = ((opts->width + TILE_SIZE - 1) / TILE_SIZE)
+		* ((r->fb.height + TILE_SIZE - 1) / TILE_SIZE);
+	if (!render_hash(opts, r->fb.height, &c->hash))
+		return (printf(ERR_FILE), FALSE);
+	c->path = ft_strjoin(opts->output, CHECKPOINT_SUFFIX);
+	c->temp = ft_strjoin(opts->output, CHECKPOINT_TEMP);
+	r->tile_done = malloc(c->tiles);
+	if (!c->path || !c->temp || !r->tile_done)
+		return (checkpoint_finish(c, r, FALSE), printf(ERR_MEMORY), FALSE);
+	ft_bzero(r->tile_done, c->tiles);
+	return (TRUE);
+}
+
+/*
+** tile_done as a bitmap, eight tiles to a byte from the low bit, written
+** to fd or, with load set, read back from it
+*/
+static int	tile_map(int fd, unsigned char *done, int tiles, int load)
+{
+	unsigned char	*bits;
+	int				ok;
+	int				i;
+
+	bits = malloc((tiles + 7) / 8);
+	if (!bits)
+		return (FALSE);
+	ft_bzero(bits, (tiles + 7) / 8);
+	i = -1;
+	while (!load && ++i < tiles)
+		bits[i / 8] |= (done[i] != 0) << (i % 8);
+	if (!load)
+		ok = write_full(fd, bits, (tiles + 7) / 8);
+	else
+		ok = read_full(fd, bits, (tiles + 7) / 8);
+	i = -1;
+	while (load && ++i < tiles)
+		done[i] = (bits[i / 8] >> (i % 8)) & 1;
+	free(bits);
+	return (ok);
+}
+
+/*
+** Sync the bands already in the output, then write the band being
+** rendered: which tiles are done and the framebuffer holding them
+*/
+static int	checkpoint_save(t_checkpoint *c, const t_render *r)
+{
+	t_checkpoint_header	header;
+	int					fd;
+	int					ok;
+
+	c->saved = time(NULL);
+	ft_bzero(&header, sizeof(header));
+	ft_memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+	header.hash = c->hash;
+	header.band_top = r->band_top;
+	header.samples = r->fb.samples;
+	header.tiles = c->tiles;
+	fd = open(c->temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return (printf(ERR_CHECKPOINT, c->temp), FALSE);
+	ok = fsync(c->fd) == 0 && write_full(fd, &header, sizeof(header))
+		&& tile_map(fd, r->tile_done, c->tiles, FALSE)
+		&& write_full(fd, r->fb.plane[0], (size_t)r->fb.width * r->fb.height
+			* 3 * sizeof(float)) && fsync(fd) == 0;
+	ok = (close(fd) == 0 && ok && rename(c->temp, c->path) == 0);
+	if (!ok)
+		printf(ERR_CHECKPOINT, c->path);
+	return (ok);
+}
+
+/*
+** Pick up where the last checkpoint left off when resuming: the band it
+** was rendering, its finished tiles and their framebuffer. Starting
+** afresh when there is none, refusing one saved for another scene, for
+** other options or for an output file that is gone.
+*/
+int	checkpoint_load(t_checkpoint *c, t_render *r, int kept)
+{
+	t_checkpoint_header	header;
+	int					fd;
+	int					ok;
+
+	if (!c->path || !c->resume)
+		return (TRUE);
+	fd = open(c->path, O_RDONLY);
+	if (fd < 0)
+		return (TRUE);
+	ok = read_full(fd, &header, sizeof(header))
+		&& ft_strncmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0
+		&& header.hash == c->hash && header.tiles == c->tiles
+		&& header.band_top >= 0 && header.band_top < r->image_height
+		&& header.band_top % r->fb.height == 0
+		&& (header.band_top == 0 || kept)
+		&& tile_map(fd, r->tile_done, c->tiles, TRUE)
+		&& read_full(fd, r->fb.plane[0], (size_t)r->fb.width * r->fb.height
+			* 3 * sizeof(float));
+	close(fd);
+	if (!ok)
+		return (printf(ERR_RESUME, c->path), FALSE);
+	r->band_top = header.band_top;
+	r->fb.samples = header.samples;
+	return (TRUE);
+}
+
+/*
+** Render the frame's tiles, on farm's worker processes when there are
+** any, CHECKPOINT_TILES at a time in traversal order, saving between
+** runs when the period is up
+*/
+int	checkpoint_render(t_checkpoint *c, t_render *r, t_farm *farm)
+{
+	int	total;
+
+	if (!c->path)
+		return (farm_run(farm, r));
+	total = r->tile_limit;
+	while (r->next_tile < total)
+	{
+		r->tile_limit = r->next_tile + CHECKPOINT_TILES;
+		if (r->tile_limit > total)
+			r->tile_limit = total;
+		if (!farm_run(farm, r))
+			return (FALSE);
+		if (time(NULL) - c->saved >= c->period && !checkpoint_save(c, r))
+			return (FALSE);
+	}
+	return (TRUE);
+}
+
+/* A band went to the output: the next one starts with no tile done */
+int	checkpoint_band(t_checkpoint *c, t_render *r)
+{
+	if (!c->path)
+		return (TRUE);
+	ft_bzero(r->tile_done, c->tiles);
+	if (time(NULL) - c->saved >= c->period)
+		return (checkpoint_save(c, r));
+	return (TRUE);
+}
+
+/* A finished render needs its checkpoint no more */
+void	checkpoint_finish(t_checkpoint *c, t_render *r, int ok)
+{
+	if (ok && c->path)
+		unlink(c->path);
+	free(c->path);
+	free(c->temp);
+	free(r->tile_done);
+	r->tile_done = NULL;
+	c->path = NULL;
+	c->temp = NULL;
+}
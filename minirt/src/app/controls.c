@@ -0,0 +1,210 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Record an edit of kind what and replace the running frame: a preview
+** unless the history covers the edit, refined when input stops
+*/
+void	controls_changed(t_vars *vars, int what)
+{
+	vars->controls.since |= what;
+	vars->controls.edited = TRUE;
+	render_async_restart(&vars->render);
+}
+
+/*
+** Turn the camera in place: yaw around the world up axis through the
+** transform API, pitch around the right axis of the orientation yawed,
+** as view_setup would build it, stopping short of vertical where the
+** view basis would flip
+*/
+static void	turn_camera(t_vars *vars, t_real yaw, t_real pitch)
+{
+	t_camera	*camera;
+	t_vec3		world_up;
+	t_vec3		dir;
+
+	camera = &vars->scene->camera;
+	camera->orientation = vec3_normalize(camera->orientation);
+	scene_rotate_camera(vars->scene, vec3_create(0, yaw, 0));
+	world_up = vec3_create(0, 1, 0);
+	if (fabs(vec3_dot(camera->orientation, world_up)) > 0.999)
+		world_up = vec3_create(0, 0, 1);
+	dir = vec3_normalize(vec3_rotate_around_axis(camera->orientation,
+				vec3_normalize(vec3_cross(camera->orientation, world_up)),
+				pitch));
+	if (pitch != 0 && fabs(dir.y) < PITCH_LIMIT)
+		camera->orientation = dir;
+	controls_changed(vars, CHANGED_CAMERA);
+}
+
+/* WASD along the view, Q and E down and up: the camera or the pick */
+static void	move(t_vars *vars, int keycode)
+{
+	const t_view	*v;
+	t_vec3			delta;
+
+	v = &vars->render.view;
+	delta = vec3_mult(v->forward, MOVE_STEP);
+	if (keycode == KEY_S)
+		delta = vec3_mult(v->forward, -MOVE_STEP);
+	else if (keycode == KEY_D)
+		delta = vec3_mult(v->right, MOVE_STEP);
+	else if (keycode == KEY_A)
+		delta = vec3_mult(v->right, -MOVE_STEP);
+	else if (keycode == KEY_E)
+		delta = vec3_mult(v->up, MOVE_STEP);
+	else if (keycode == KEY_Q)
+		delta = vec3_mult(v->up, -MOVE_STEP);
+	if (vars->controls.selected >= 0)
+	{
+		vars->controls.drag = vec3_add(vars->controls.drag, delta);
+		controls_changed(vars, CHANGED_GEOMETRY);
+		return ;
+	}
+	scene_translate_camera(vars->scene, delta);
+	controls_changed(vars, CHANGED_CAMERA);
+}
+
+int	controls_key(int keycode, t_vars *vars)
+{
+	if (keycode == KEY_ESC)
+		mlx_loop_end(vars->mlx);
+	else if (keycode == KEY_R)
+	{
+		vars->controls.refresh = 0;
+		render_async_restart(&vars->render);
+	}
+	else if (keycode == KEY_W || keycode == KEY_A || keycode == KEY_S
+		|| keycode == KEY_D || keycode == KEY_Q || keycode == KEY_E)
+		move(vars, keycode);
+	else if (keycode == KEY_LEFT || keycode == KEY_RIGHT)
+		turn_camera(vars, TURN_STEP - 2 * TURN_STEP * (keycode == KEY_RIGHT),
+			0);
+	else if (keycode == KEY_UP || keycode == KEY_DOWN)
+		turn_camera(vars, 0, TURN_STEP - 2 * TURN_STEP
+			* (keycode == KEY_DOWN));
+	else
+		controls_light_key(keycode, vars);
+	return (0);
+}
+
+/*
+** Left click picks the object under the pointer with a primary ray of
+** the frame on screen, or the camera again on a miss. The compiled scene
+** is only read here, so the workers may keep running.
+*/
+int	controls_press(int button, int x, int y, t_vars *vars)
+{
+	t_ray	ray;
+	t_hit	hit;
+
+	if (button == MOUSE_RIGHT)
+	{
+		vars->controls.look = TRUE;
+		vars->controls.mouse[0] = x;
+		vars->controls.mouse[1] = y;
+	}
+	if (button != MOUSE_LEFT || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+		return (0);
+	ray = view_ray(&vars->render.view, x + 0.5, y + 0.5);
+	hit.t = INFINITY;
+	hit.index = -1;
+	hit.part = PART_SIDE;
+	closest_in_span(&vars->render.compiled, vars->render.compiled.all,
+		&ray, &hit);
+	vars->controls.selected = hit.index;
+	return (0);
+}
+
+int	controls_release(int button, int x, int y, t_vars *vars)
+{
+	(void)x;
+	(void)y;
+	if (button == MOUSE_RIGHT)
+		vars->controls.look = FALSE;
+	return (0);
+}
+
+/* Mouse-look while the right button is held */
+int	controls_motion(int x, int y, t_vars *vars)
+{
+	int	dx;
+	int	dy;
+
+	if (!vars->controls.look)
+		return (0);
+	dx = x - vars->controls.mouse[0];
+	dy = y - vars->controls.mouse[1];
+	vars->controls.mouse[0] = x;
+	vars->controls.mouse[1] = y;
+	if (dx != 0 || dy != 0)
+		turn_camera(vars, -dx * MOUSE_TURN, -dy * MOUSE_TURN);
+	return (0);
+}
+
+/* Move the picked object, refresh its records and refit the BVH */
+static void	apply_drag(t_vars *vars)
+{
+	t_controls	*c;
+
+	c = &vars->controls;
+	if (c->selected < 0 || (c->drag.x == 0 && c->drag.y == 0
+			&& c->drag.z == 0))
+		return ;
+	scene_translate_object(vars->scene, c->selected, c->drag);
+	compile_object(&vars->render.compiled, c->selected);
+	bvh_refit(vars->scene->bvh, vars->scene->objects);
+	c->drag = vec3_create(0, 0, 0);
+}
+
+/*
+** Pick the next frame from what changed since the last committed one.
+** A camera move alone is reprojected, as are the HISTORY_AGE frames
+** refreshing it afterwards. A lighting edit alone is shaded from the
+** history, with its shadow tests unless the light moved.
+*/
+static void	frame_mode(t_controls *c, t_render *r)
+{
+	r->reproject = FALSE;
+	r->relight = RELIGHT_OFF;
+	if (c->since == CHANGED_CAMERA)
+		c->refresh = HISTORY_AGE;
+	else if (c->since != 0)
+		c->refresh = 0;
+	if (!r->has_history)
+		return ;
+	if (c->since == CHANGED_CAMERA)
+		r->reproject = TRUE;
+	else if (c->since == 0 && c->refresh > 0)
+	{
+		r->reproject = TRUE;
+		c->refresh--;
+	}
+	else if ((c->since & CHANGED_LIGHT)
+		&& !(c->since & (CHANGED_CAMERA | CHANGED_GEOMETRY)))
+		r->relight = RELIGHT_SHADOWS;
+	else if (c->since == CHANGED_SHADING)
+		r->relight = RELIGHT_SHADE;
+}
+
+/*
+** Between frames: apply the pending edits and pick the next frame. What
+** the history cannot cover is traced, as a preview while the user is
+** still editing.
+*/
+void	controls_apply(t_vars *vars)
+{
+	t_controls	*c;
+	t_render	*r;
+
+	c = &vars->controls;
+	r = &vars->render;
+	frame_mode(c, r);
+	r->preview = 1;
+	if (c->edited && !r->reproject && r->relight == RELIGHT_OFF)
+		r->preview = PREVIEW_BLOCK;
+	if (c->since & (CHANGED_LIGHT | CHANGED_SHADING))
+		controls_apply_light(vars);
+	c->edited = FALSE;
+	apply_drag(vars);
+}
@@ -0,0 +1,99 @@
+#include "../../includes/minirt_app.h"
+
+static t_real	clamp_unit(t_real v)
+{
+	if (v < 0)
+		return (0);
+	if (v > 1)
+		return (1);
+	return (v);
+}
+
+/* I/K, J/L and U/O move the light along the view axes */
+static void	move_light(t_vars *vars, int keycode)
+{
+	const t_view	*v;
+	t_vec3			delta;
+
+	v = &vars->render.view;
+	delta = vec3_mult(v->forward, LIGHT_STEP);
+	if (keycode == KEY_K)
+		delta = vec3_mult(v->forward, -LIGHT_STEP);
+	else if (keycode == KEY_L)
+		delta = vec3_mult(v->right, LIGHT_STEP);
+	else if (keycode == KEY_J)
+		delta = vec3_mult(v->right, -LIGHT_STEP);
+	else if (keycode == KEY_O)
+		delta = vec3_mult(v->up, LIGHT_STEP);
+	else if (keycode == KEY_U)
+		delta = vec3_mult(v->up, -LIGHT_STEP);
+	vars->controls.light.position = vec3_add(vars->controls.light.position,
+			delta);
+	vars->controls.since |= CHANGED_LIGHT;
+}
+
+/*
+** Light and material keys. They edit the copies in t_controls, applied
+** between frames, and ask for a relit frame: the geometry seen from the
+** camera is unchanged, and so are the shadows unless the light moved.
+** Returns FALSE for any other key.
+*/
+int	controls_light_key(int keycode, t_vars *vars)
+{
+	t_controls	*c;
+
+	c = &vars->controls;
+	if (keycode == KEY_I || keycode == KEY_K || keycode == KEY_J
+		|| keycode == KEY_L || keycode == KEY_U || keycode == KEY_O)
+		move_light(vars, keycode);
+	else if (keycode == KEY_BRACKET_L || keycode == KEY_BRACKET_R)
+		c->light.brightness = clamp_unit(c->light.brightness + LIGHT_GAIN
+				- 2 * LIGHT_GAIN * (keycode == KEY_BRACKET_L));
+	else if (keycode == KEY_COMMA || keycode == KEY_PERIOD)
+		c->ambient.ratio = clamp_unit(c->ambient.ratio + LIGHT_GAIN
+				- 2 * LIGHT_GAIN * (keycode == KEY_COMMA));
+	else if (keycode == KEY_C && c->selected >= 0)
+		c->recolor++;
+	else
+		return (FALSE);
+	controls_changed(vars, CHANGED_SHADING);
+	return (TRUE);
+}
+
+static t_material	*object_material(t_object *obj)
+{
+	if (obj->type == SPHERE)
+		return (&obj->data.sphere.material);
+	if (obj->type == PLANE)
+		return (&obj->data.plane.material);
+	if (obj->type == CYLINDER)
+		return (&obj->data.cylinder.material);
+	if (obj->type == CONE)
+		return (&obj->data.cone.material);
+	if (obj->type == BOX)
+		return (&obj->data.box.material);
+	if (obj->type == QUAD)
+		return (&obj->data.quad.material);
+	return (&obj->data.disc.material);
+}
+
+/*
+** Between frames: copy the edited light and ambient into the scene and
+** give the picked object its new color, one channel rotation per C
+*/
+void	controls_apply_light(t_vars *vars)
+{
+	t_controls	*c;
+	t_material	*m;
+
+	c = &vars->controls;
+	vars->scene->light = c->light;
+	vars->scene->ambient = c->ambient;
+	if (c->recolor == 0 || c->selected < 0)
+		return ;
+	m = object_material(&vars->scene->objects[c->selected]);
+	while (c->recolor-- > 0)
+		m->color = vec3_create(m->color.z, m->color.x, m->color.y);
+	c->recolor = 0;
+	compile_object(&vars->render.compiled, c->selected);
+}
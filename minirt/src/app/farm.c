@@ -0,0 +1,71 @@
+#include "../../includes/minirt_app.h"
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/*
+** Fork one worker on a fresh socket pair. The child gets the compiled
+** scene with the rest of the coordinator's memory, closes the sockets of
+** the workers before it and never returns.
+*/
+static int	spawn(t_farm *f, t_render *r)
+{
+	int		pair[2];
+	pid_t	pid;
+	int		i;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+		return (FALSE);
+	pid = fork();
+	if (pid == 0)
+	{
+		close(pair[0]);
+		i = -1;
+		while (++i < f->count)
+			close(f->fd[i]);
+		farm_worker(r, pair[1]);
+		_exit(EXIT_SUCCESS);
+	}
+	close(pair[1]);
+	if (pid < 0)
+		return (close(pair[0]), FALSE);
+	f->fd[f->count] = pair[0];
+	f->pid[f->count++] = pid;
+	return (TRUE);
+}
+
+/*
+** Start opts->workers worker processes, as many as will start, for a
+** zeroed farm. With none the coordinator renders on its own threads. A
+** worker gone mid-write must not take the coordinator with it.
+*/
+int	farm_start(t_farm *f, t_render *r, const t_options *opts)
+{
+	if (!opts->workers)
+		return (TRUE);
+	f->requeue = malloc(sizeof(int) * ((r->fb.width + TILE_SIZE - 1)
+				/ TILE_SIZE) * ((r->fb.height + TILE_SIZE - 1) / TILE_SIZE));
+	if (!f->requeue)
+		return (printf(ERR_MEMORY), FALSE);
+	signal(SIGPIPE, SIG_IGN);
+	fflush(stdout);
+	while (f->count < opts->workers && spawn(f, r))
+		;
+	return (TRUE);
+}
+
+void	farm_stop(t_farm *f)
+{
+	int	i;
+
+	i = -1;
+	while (++i < f->count)
+	{
+		if (f->fd[i] >= 0)
+			close(f->fd[i]);
+		if (f->pid[i] > 0)
+			waitpid(f->pid[i], NULL, 0);
+	}
+	free(f->requeue);
+	ft_bzero(f, sizeof(t_farm));
+}
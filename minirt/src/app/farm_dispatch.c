@@ -0,0 +1,150 @@
+#include "../../includes/minirt_app.h"
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+/* A worker died or misbehaved: stop it and take its tiles back */
+static void	lose(t_farm *f, int w)
+{
+	while (f->pending[w] > 0)
+		f->requeue[f->requeued++] = f->sent[w][--f->pending[w]];
+	close(f->fd[w]);
+	f->fd[w] = -1;
+	kill(f->pid[w], SIGKILL);
+	waitpid(f->pid[w], NULL, 0);
+	f->pid[w] = -1;
+}
+
+/* Tiles taken back first, then the frame's in traversal order */
+static int	next_tile(t_farm *f, t_render *r)
+{
+	int	tile;
+
+	if (f->requeued > 0)
+		return (f->requeue[--f->requeued]);
+	while (f->cursor < r->tile_limit)
+	{
+		tile = r->tile_order[f->cursor++];
+		if (!r->tile_done || !r->tile_done[tile])
+			return (tile);
+	}
+	return (-1);
+}
+
+/* Keep every live worker FARM_DEPTH tiles ahead, FALSE when none is left */
+static int	dispatch(t_farm *f, t_render *r)
+{
+	int	request[2];
+	int	live;
+	int	w;
+
+	live = FALSE;
+	w = -1;
+	while (++w < f->count)
+	{
+		while (f->fd[w] >= 0 && f->pending[w] < FARM_DEPTH)
+		{
+			request[0] = r->band_top;
+			request[1] = next_tile(f, r);
+			if (request[1] < 0)
+				break ;
+			f->sent[w][f->pending[w]++] = request[1];
+			if (!write_full(f->fd[w], request, sizeof(request)))
+				lose(f, w);
+		}
+		live |= (f->fd[w] >= 0);
+	}
+	return (live);
+}
+
+/*
+** Store the tile worker w sent back, the oldest it was sent. Anything
+** else, or a short message, loses the worker. Returns the tiles stored.
+*/
+static int	receive(t_farm *f, t_render *r, int w)
+{
+	float	pixels[TILE_SIZE * TILE_SIZE * 3];
+	int		tile;
+
+	if (!read_full(f->fd[w], &tile, sizeof(tile)) || tile != f->sent[w][0]
+		|| !read_full(f->fd[w], pixels, sizeof(pixels)))
+		return (lose(f, w), 0);
+	farm_tile(r, tile, pixels, TRUE);
+	if (r->tile_done)
+		r->tile_done[tile] = TRUE;
+	f->pending[w]--;
+	ft_memmove(f->sent[w], f->sent[w] + 1, f->pending[w] * sizeof(int));
+	return (1);
+}
+
+/* Wait for the workers with tiles out, then take what they returned */
+static int	collect(t_farm *f, t_render *r)
+{
+	struct pollfd	fds[MAX_WORKERS];
+	int				got;
+	int				w;
+
+	w = -1;
+	while (++w < f->count)
+	{
+		fds[w].fd = f->fd[w];
+		if (f->pending[w] == 0)
+			fds[w].fd = -1;
+		fds[w].events = POLLIN;
+		fds[w].revents = 0;
+	}
+	if (poll(fds, f->count, -1) < 0)
+		return (0);
+	got = 0;
+	w = -1;
+	while (++w < f->count)
+		if (fds[w].fd >= 0 && fds[w].revents)
+			got += receive(f, r, w);
+	return (got);
+}
+
+static int	tiles_left(const t_render *r)
+{
+	int	left;
+	int	i;
+
+	left = 0;
+	i = r->next_tile - 1;
+	while (++i < r->tile_limit)
+		left += (!r->tile_done || !r->tile_done[r->tile_order[i]]);
+	return (left);
+}
+
+/*
+** Render tiles next_tile to tile_limit of the frame on the worker
+** processes, dealt out in traversal order as the workers return theirs.
+** The tiles of a worker that dies go to the others, or to the
+** coordinator itself once none is left. Without workers the frame runs
+** on the render threads.
+*/
+int	farm_run(t_farm *f, t_render *r)
+{
+	int	left;
+	int	tile;
+
+	if (f->count == 0)
+	{
+		render_run_workers(r, render_worker);
+		r->next_tile = r->tile_limit;
+		return (TRUE);
+	}
+	f->cursor = r->next_tile;
+	left = tiles_left(r);
+	while (left > 0 && dispatch(f, r))
+		left -= collect(f, r);
+	tile = next_tile(f, r);
+	while (tile >= 0)
+	{
+		render_tile(r, tile);
+		if (r->tile_done)
+			r->tile_done[tile] = TRUE;
+		tile = next_tile(f, r);
+	}
+	r->next_tile = r->tile_limit;
+	return (TRUE);
+}
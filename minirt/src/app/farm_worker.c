@@ -0,0 +1,75 @@
+#include "../../includes/minirt_app.h"
+
+/* Pixel rectangle {x, y, width, y end} of a tile, clipped to the band */
+static void	tile_rect(const t_render *r, int tile, int rect[4])
+{
+	rect[0] = (tile % r->bins.tiles_x) * TILE_SIZE;
+	rect[1] = (tile / r->bins.tiles_x) * TILE_SIZE;
+	rect[2] = r->view.width - rect[0];
+	if (rect[2] > TILE_SIZE)
+		rect[2] = TILE_SIZE;
+	rect[3] = r->view.height;
+	if (rect[3] > rect[1] + TILE_SIZE)
+		rect[3] = rect[1] + TILE_SIZE;
+}
+
+/*
+** Copy the framebuffer pixels of a tile of the current band to pixels,
+** plane after plane and row after row, or with load set back from it.
+** Tiles cut by the image edge use the start of the buffer.
+*/
+void	farm_tile(t_render *r, int tile, float *pixels, int load)
+{
+	float	*row;
+	int		rect[4];
+	int		c;
+	int		y;
+
+	tile_rect(r, tile, rect);
+	c = -1;
+	while (++c < 3)
+	{
+		y = rect[1] - 1;
+		while (++y < rect[3])
+		{
+			row = r->fb.plane[c] + (size_t)y * r->fb.width + rect[0];
+			if (load)
+				ft_memcpy(row, pixels, rect[2] * sizeof(float));
+			else
+				ft_memcpy(pixels, row, rect[2] * sizeof(float));
+			pixels += rect[2];
+		}
+	}
+}
+
+/*
+** Worker process loop: a request is a band's first row and a tile of
+** it. The band is set up when it changes, the tile rendered and sent
+** back as its number followed by its pixels, until the coordinator
+** hangs up.
+*/
+void	farm_worker(t_render *r, int fd)
+{
+	float	pixels[TILE_SIZE * TILE_SIZE * 3];
+	int		request[2];
+	int		band;
+
+	ft_bzero(pixels, sizeof(pixels));
+	band = -1;
+	while (read_full(fd, request, sizeof(request)))
+	{
+		if (request[0] != band)
+		{
+			band = request[0];
+			r->band_top = band;
+			if (!render_frame_begin(r))
+				break ;
+		}
+		render_tile(r, request[1]);
+		farm_tile(r, request[1], pixels, FALSE);
+		if (!write_full(fd, &request[1], sizeof(request[1]))
+			|| !write_full(fd, pixels, sizeof(pixels)))
+			break ;
+	}
+	close(fd);
+}
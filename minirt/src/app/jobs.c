@@ -0,0 +1,135 @@
+#include "../../includes/minirt_app.h"
+#include <time.h>
+
+static double	now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6);
+}
+
+/*
+** Next job of the list, its line parsed like a render server request.
+** Blank lines and # comments are skipped. FALSE at the end of the list.
+*/
+static int	job_read(t_jobs *j, t_job *job)
+{
+	int	argc;
+
+	job->entry = NULL;
+	job->hit = FALSE;
+	while (getline(&job->line, &job->size, j->file) >= 0)
+	{
+		j->line++;
+		argc = split_request(job->line, job->argv);
+		if (argc > 1 && job->argv[1][0] != '#')
+		{
+			job->number = j->line;
+			job->ok = request_options(argc, job->argv, &job->opts);
+			return (TRUE);
+		}
+	}
+	return (FALSE);
+}
+
+/* Get a job's scene from the cache, loading it when it is not there */
+static void	*job_load(void *arg)
+{
+	t_job	*job;
+
+	job = (t_job *)arg;
+	job->entry = cache_acquire(job->cache, job->opts.scene_path, &job->hit);
+	return (NULL);
+}
+
+static void	job_render(t_jobs *j, t_job *job)
+{
+	if (job->ok && job->entry && render_cached(job->entry, &job->opts))
+	{
+		j->done++;
+		j->pixels += (double)job->opts.width * job->opts.height;
+	}
+	else
+	{
+		j->failed++;
+		printf(ERR_JOB, job->number);
+	}
+	if (job->entry && !job->hit)
+		j->loaded++;
+	if (job->entry)
+		cache_release(&j->cache, job->entry);
+}
+
+/*
+** Render the jobs in order, each on every render thread, while a
+** thread of its own gets the next one's scene: parsing and building
+** overlap rendering. Jobs of a scene already cached share it.
+*/
+static void	jobs_loop(t_jobs *j)
+{
+	pthread_t	thread;
+	t_job		*next;
+	int			loading;
+	int			more;
+	int			i;
+
+	i = 0;
+	more = job_read(j, &j->job[0]);
+	if (more && j->job[0].ok)
+		job_load(&j->job[0]);
+	while (more)
+	{
+		next = &j->job[(i + 1) % 2];
+		more = job_read(j, next);
+		loading = (more && next->ok
+				&& pthread_create(&thread, NULL, job_load, next) == 0);
+		job_render(j, &j->job[i % 2]);
+		if (loading)
+			pthread_join(thread, NULL);
+		else if (more && next->ok)
+			job_load(next);
+		i++;
+	}
+}
+
+static void	jobs_report(const t_jobs *j, double ms)
+{
+	printf("%d jobs rendered, %d failed, %d scenes loaded in %.2f s\n",
+		j->done, j->failed, j->loaded, ms / 1000.0);
+	if (ms > 0.0)
+		printf("%.2f jobs/s, %.2f Mpixel/s\n", (j->done + j->failed)
+			* 1000.0 / ms, j->pixels / (ms * 1000.0));
+}
+
+/*
+** Batch mode: render every job of the list in this one process. Scenes
+** stay in the render server's cache, so jobs naming the same file
+** parse, build and compile it once between them.
+*/
+int	jobs_run(const t_options *opts)
+{
+	t_jobs	j;
+	double	start;
+	int		ok;
+
+	ft_bzero(&j, sizeof(t_jobs));
+	j.file = fopen(opts->jobs, "r");
+	if (!j.file)
+		return (printf(ERR_JOBS, opts->jobs), FALSE);
+	pthread_mutex_init(&j.cache.lock, NULL);
+	pthread_mutex_init(&j.cache.load, NULL);
+	j.job[0].cache = &j.cache;
+	j.job[1].cache = &j.cache;
+	start = now_ms();
+	jobs_loop(&j);
+	jobs_report(&j, now_ms() - start);
+	cache_clear(&j.cache);
+	pthread_mutex_destroy(&j.cache.lock);
+	pthread_mutex_destroy(&j.cache.load);
+	free(j.job[0].line);
+	free(j.job[1].line);
+	ok = (j.failed == 0 && !ferror(j.file));
+	fclose(j.file);
+	return (ok);
+}
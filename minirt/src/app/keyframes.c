@@ -0,0 +1,168 @@
+#include "../../includes/minirt_app.h"
+
+/* Append a key, the array doubling when full */
+static int	key_push(t_animation *anim, const t_keyframe *key)
+{
+	t_keyframe	*keys;
+
+	if (anim->count == anim->size)
+	{
+		anim->size = anim->size * 2 + 8;
+		keys = malloc(sizeof(t_keyframe) * anim->size);
+		if (!keys)
+			return (printf(ERR_MEMORY), FALSE);
+		if (anim->count)
+			ft_memcpy(keys, anim->keys, sizeof(t_keyframe) * anim->count);
+		free(anim->keys);
+		anim->keys = keys;
+	}
+	anim->keys[anim->count++] = *key;
+	return (TRUE);
+}
+
+/*
+** K <time> <x,y,z> <direction> <fov>: the camera at time, in seconds,
+** given as the scene's C line gives it
+*/
+static int	key_parse(char **tokens, int count, t_keyframe *key)
+{
+	double	fov;
+
+	if (count != 5 || ft_strncmp(tokens[0], "K", 2) != 0
+		|| !parse_double(tokens[1], &key->time)
+		|| !parse_vector(tokens[2], &key->camera.position)
+		|| !parse_vector(tokens[3], &key->camera.orientation)
+		|| !parse_double(tokens[4], &fov)
+		|| vec3_length(key->camera.orientation) <= RT_EPSILON
+		|| fov <= 0.0 || fov > 180.0)
+		return (FALSE);
+	key->camera.orientation = vec3_normalize(key->camera.orientation);
+	key->camera.fov = fov;
+	return (TRUE);
+}
+
+/* Read the keys of file, blank lines and # comments skipped */
+static int	keys_read(FILE *file, const char *path, t_animation *anim)
+{
+	t_keyframe	key;
+	char		*tokens[6];
+	char		*line;
+	size_t		size;
+	int			count;
+	int			n;
+
+	line = NULL;
+	size = 0;
+	n = 0;
+	while (getline(&line, &size, file) >= 0)
+	{
+		n++;
+		count = split_fields(line, " \t\r\n", tokens, 6);
+		if (count == 0 || tokens[0][0] == '#')
+			continue ;
+		if (!key_parse(tokens, count, &key) || (anim->count > 0
+				&& key.time <= anim->keys[anim->count - 1].time))
+			return (free(line), printf(ERR_KEYFRAME, n, path), FALSE);
+		if (!key_push(anim, &key))
+			return (free(line), FALSE);
+	}
+	free(line);
+	return (TRUE);
+}
+
+/*
+** Load a camera animation: two keys or more, their times increasing.
+** Key positions are world positions, moved onto scene's base. Nothing
+** to free on failure.
+*/
+int	animation_load(const char *path, const t_scene *scene, t_animation *anim)
+{
+	FILE	*file;
+	int		ok;
+	int		i;
+
+	ft_bzero(anim, sizeof(t_animation));
+	file = fopen(path, "r");
+	if (!file)
+		return (printf(ERR_FILE_ACCESS, path), FALSE);
+	ok = keys_read(file, path, anim);
+	fclose(file);
+	i = -1;
+	while (ok && ++i < anim->count)
+		anim->keys[i].camera.position = scene_rebase(scene,
+				anim->keys[i].camera.position);
+	if (ok && anim->count < 2)
+	{
+		printf(ERR_KEYFRAMES, path);
+		ok = FALSE;
+	}
+	if (!ok)
+	{
+		free(anim->keys);
+		ft_bzero(anim, sizeof(t_animation));
+	}
+	return (ok);
+}
+
+/*
+** Catmull-Rom spline through p[1] at u = 0 and p[2] at u = 1, p[0] and
+** p[3] giving the tangents
+*/
+static t_vec3	spline(const t_vec3 p[4], t_real u)
+{
+	t_vec3	a;
+	t_vec3	b;
+	t_vec3	c;
+
+	a = vec3_sub(p[2], p[0]);
+	b = vec3_add(vec3_sub(vec3_mult(p[0], 2.0), vec3_mult(p[1], 5.0)),
+			vec3_sub(vec3_mult(p[2], 4.0), p[3]));
+	c = vec3_add(vec3_sub(vec3_mult(p[1], 3.0), p[0]),
+			vec3_sub(p[3], vec3_mult(p[2], 3.0)));
+	return (vec3_add(p[1], vec3_mult(vec3_add(a, vec3_mult(vec3_add(b,
+							vec3_mult(c, u)), u)), 0.5 * u)));
+}
+
+/* Camera of key i, the end keys standing in past either end */
+static const t_camera	*key_camera(const t_animation *anim, int i)
+{
+	if (i < 0)
+		i = 0;
+	if (i >= anim->count)
+		i = anim->count - 1;
+	return (&anim->keys[i].camera);
+}
+
+/*
+** The camera at time: position and direction follow splines through
+** the keys, the field of view goes linearly from key to key. Times
+** outside the keys hold the first or last one.
+*/
+void	animation_camera(const t_animation *anim, double time, t_camera *camera)
+{
+	const t_keyframe	*k;
+	t_vec3				p[2][4];
+	double				u;
+	int					i;
+	int					j;
+
+	i = 0;
+	while (i + 2 < anim->count && anim->keys[i + 1].time <= time)
+		i++;
+	k = anim->keys;
+	u = (time - k[i].time) / (k[i + 1].time - k[i].time);
+	u = fmin(fmax(u, 0.0), 1.0);
+	j = -1;
+	while (++j < 4)
+	{
+		p[0][j] = key_camera(anim, i - 1 + j)->position;
+		p[1][j] = key_camera(anim, i - 1 + j)->orientation;
+	}
+	camera->position = spline(p[0], u);
+	camera->orientation = spline(p[1], u);
+	if (vec3_length(camera->orientation) <= RT_EPSILON)
+		camera->orientation = p[1][1];
+	camera->orientation = vec3_normalize(camera->orientation);
+	camera->fov = k[i].camera.fov + (k[i + 1].camera.fov - k[i].camera.fov)
+		* u;
+}
@@ -0,0 +1,262 @@
+#include "../../includes/minirt_app.h"
+
+static int	parse_order(const char *name, int *order)
+{
+	if (ft_strncmp(name, "row", 4) == 0)
+		*order = ORDER_ROW;
+	else if (ft_strncmp(name, "morton", 7) == 0)
+		*order = ORDER_MORTON;
+	else if (ft_strncmp(name, "hilbert", 8) == 0)
+		*order = ORDER_HILBERT;
+	else
+		return (printf(ERR_ORDER, name), FALSE);
+	return (TRUE);
+}
+
+/* 0 lets the parser decide from the file size */
+static int	parse_threads(const char *arg, int *threads)
+{
+	*threads = ft_atoi(arg);
+	if (!ft_isdigit(arg[0]) || *threads < 0 || *threads > MAX_PARSE_THREADS)
+		return (printf(ERR_PARSE_THREADS, arg), FALSE);
+	return (TRUE);
+}
+
+/* Headless image size, the window always uses WIDTH x HEIGHT */
+static int	parse_size(const char *arg, int *width, int *height)
+{
+	const char	*x;
+
+	x = ft_strchr(arg, 'x');
+	*width = ft_atoi(arg);
+	*height = 0;
+	if (x)
+		*height = ft_atoi(x + 1);
+	if (!x || !ft_isdigit(arg[0]) || !ft_isdigit(x[1]) || *width <= 0
+		|| *height <= 0 || *width > MAX_IMAGE_SIDE || *height > MAX_IMAGE_SIDE)
+		return (printf(ERR_SIZE, arg), FALSE);
+	return (TRUE);
+}
+
+/*
+** Exposure multiplies the linear framebuffer, the tone curve encodes
+** it: linear truncates to 8 bits as the renderer always did, srgb
+** applies the sRGB curve with ordered dithering
+*/
+static int	parse_tone(const char *option, char *arg, t_options *opts)
+{
+	if (ft_strncmp(option, "--exposure", 11) == 0)
+	{
+		if (!parse_double(arg, &opts->exposure) || opts->exposure <= 0)
+			return (printf(ERR_EXPOSURE, arg), FALSE);
+	}
+	else if (ft_strncmp(arg, "linear", 7) == 0)
+		opts->transfer = TRANSFER_LINEAR;
+	else if (ft_strncmp(arg, "srgb", 5) == 0)
+		opts->transfer = TRANSFER_SRGB;
+	else
+		return (printf(ERR_TONEMAP, arg), FALSE);
+	return (TRUE);
+}
+
+/*
+** Byte count with an optional K, M or G suffix, binary multiples. Up to
+** ten digits, so the shifted count cannot overflow.
+*/
+static int	parse_memory(const char *arg, size_t *bytes)
+{
+	const char	*units;
+	const char	*unit;
+	int			i;
+
+	units = "KMG";
+	*bytes = 0;
+	i = 0;
+	while (i < 10 && ft_isdigit(arg[i]))
+		*bytes = *bytes * 10 + (arg[i++] - '0');
+	unit = NULL;
+	if (i > 0 && arg[i])
+		unit = ft_strchr(units, arg[i]);
+	if (unit)
+		*bytes <<= 10 * (unit - units + 1);
+	if (i == 0 || *bytes == 0 || (arg[i] && (!unit || arg[i + 1])))
+		return (printf(ERR_MAX_MEMORY, arg), FALSE);
+	return (TRUE);
+}
+
+/* Options of the headless --output render which take a value */
+static int	parse_batch(const char *option, char *arg, t_options *opts)
+{
+	if (ft_strncmp(option, "--max-memory", 13) == 0)
+		return (parse_memory(arg, &opts->max_memory));
+	if (ft_strncmp(option, "--checkpoint", 13) == 0)
+	{
+		opts->checkpoint = ft_atoi(arg);
+		if (!ft_isdigit(arg[0]) || opts->checkpoint <= 0)
+			return (printf(ERR_PERIOD, arg), FALSE);
+		return (TRUE);
+	}
+	if (ft_strncmp(option, "--frames", 9) == 0)
+	{
+		opts->frames = ft_atoi(arg);
+		if (!ft_isdigit(arg[0]) || opts->frames < 1
+			|| opts->frames > MAX_FRAMES)
+			return (printf(ERR_FRAMES, arg), FALSE);
+		return (TRUE);
+	}
+	opts->workers = ft_atoi(arg);
+	if (!ft_isdigit(arg[0]) || opts->workers < 1
+		|| opts->workers > MAX_WORKERS)
+		return (printf(ERR_WORKERS, arg), FALSE);
+	return (TRUE);
+}
+
+/*
+** Camera overrides: --camera moves it, --look turns it to a direction,
+** --fov sets its horizontal field of view, as the scene's C line would
+*/
+static int	parse_view(const char *option, char *arg, t_options *opts)
+{
+	int	ok;
+
+	if (ft_strncmp(option, "--camera", 9) == 0)
+	{
+		ok = parse_vector(arg, &opts->camera_position);
+		opts->camera |= OVERRIDE_POSITION;
+	}
+	else if (ft_strncmp(option, "--look", 7) == 0)
+	{
+		ok = parse_vector(arg, &opts->camera_direction)
+			&& vec3_length(opts->camera_direction) > RT_EPSILON;
+		opts->camera |= OVERRIDE_DIRECTION;
+	}
+	else
+	{
+		ok = parse_double(arg, &opts->fov) && opts->fov > 0.0
+			&& opts->fov <= 180.0;
+		opts->camera |= OVERRIDE_FOV;
+	}
+	if (!ok)
+		return (printf(ERR_CAMERA, option, arg), FALSE);
+	return (TRUE);
+}
+
+/* --camera is a world position, moved onto the scene's base */
+void	options_camera(t_scene *scene, const t_options *opts)
+{
+	t_camera	*camera;
+
+	camera = &scene->camera;
+	if (opts->camera & OVERRIDE_POSITION)
+		camera->position = scene_rebase(scene, opts->camera_position);
+	if (opts->camera & OVERRIDE_DIRECTION)
+		camera->orientation = vec3_normalize(opts->camera_direction);
+	if (opts->camera & OVERRIDE_FOV)
+		camera->fov = opts->fov;
+}
+
+void	render_apply_options(t_render *render, const t_options *opts)
+{
+	render->order = opts->order;
+	render->fb.exposure = opts->exposure;
+	render->fb.transfer = opts->transfer;
+}
+
+/*
+** minirt <scene.rt> [--order row|morton|hilbert] [--bench]
+**                   [--output file.ppm|file.pfm] [--size WxH]
+**                   [--parse-threads n] [--exposure e]
+**                   [--tonemap linear|srgb] [--max-memory bytes[K|M|G]]
+**                   [--checkpoint seconds] [--resume] [--workers n]
+**                   [--camera x,y,z] [--look x,y,z] [--fov degrees]
+**                   [--animate keyframes] [--frames n]
+** minirt --server socket
+** minirt --jobs list
+**
+** A .pfm output is written as linear floats. --max-memory bounds what
+** the --output image holds in memory, rendering it in bands of rows.
+** --checkpoint saves the progress of the --output render that often,
+** --resume continues from the last save, checkpointing as it goes.
+** --workers renders its tiles in that many worker processes.
+** --animate renders the camera path the keyframes file describes as
+** numbered --output frames, --frames of them or ANIMATION_FPS a second.
+** --server serves renders on a Unix socket instead, taking the same
+** options a line at a time. --jobs renders each line of the list the
+** same way, one after another.
+*/
+int	parse_options(int argc, char **argv, t_options *opts)
+{
+	int	i;
+
+	ft_bzero(opts, sizeof(t_options));
+	opts->order = ORDER_HILBERT;
+	opts->width = WIDTH;
+	opts->height = HEIGHT;
+	opts->exposure = 1.0;
+	i = 0;
+	while (++i < argc)
+	{
+		if (ft_strncmp(argv[i], "--order", 8) == 0 && i + 1 < argc)
+		{
+			if (!parse_order(argv[++i], &opts->order))
+				return (FALSE);
+		}
+		else if (ft_strncmp(argv[i], "--bench", 8) == 0)
+			opts->bench = TRUE;
+		else if (ft_strncmp(argv[i], "--output", 9) == 0 && i + 1 < argc)
+			opts->output = argv[++i];
+		else if ((ft_strncmp(argv[i], "--max-memory", 13) == 0
+				|| ft_strncmp(argv[i], "--checkpoint", 13) == 0
+				|| ft_strncmp(argv[i], "--workers", 10) == 0
+				|| ft_strncmp(argv[i], "--frames", 9) == 0) && i + 1 < argc)
+		{
+			if (!parse_batch(argv[i], argv[i + 1], opts))
+				return (FALSE);
+			i++;
+		}
+		else if ((ft_strncmp(argv[i], "--camera", 9) == 0
+				|| ft_strncmp(argv[i], "--look", 7) == 0
+				|| ft_strncmp(argv[i], "--fov", 6) == 0) && i + 1 < argc)
+		{
+			if (!parse_view(argv[i], argv[i + 1], opts))
+				return (FALSE);
+			i++;
+		}
+		else if (ft_strncmp(argv[i], "--server", 9) == 0 && i + 1 < argc)
+			opts->server = argv[++i];
+		else if (ft_strncmp(argv[i], "--jobs", 7) == 0 && i + 1 < argc)
+			opts->jobs = argv[++i];
+		else if (ft_strncmp(argv[i], "--animate", 10) == 0 && i + 1 < argc)
+			opts->animate = argv[++i];
+		else if (ft_strncmp(argv[i], "--resume", 9) == 0)
+			opts->resume = TRUE;
+		else if (ft_strncmp(argv[i], "--size", 7) == 0 && i + 1 < argc)
+		{
+			if (!parse_size(argv[++i], &opts->width, &opts->height))
+				return (FALSE);
+		}
+		else if (ft_strncmp(argv[i], "--parse-threads", 16) == 0
+			&& i + 1 < argc)
+		{
+			if (!parse_threads(argv[++i], &opts->parse_threads))
+				return (FALSE);
+		}
+		else if ((ft_strncmp(argv[i], "--exposure", 11) == 0
+				|| ft_strncmp(argv[i], "--tonemap", 10) == 0) && i + 1 < argc)
+		{
+			if (!parse_tone(argv[i], argv[i + 1], opts))
+				return (FALSE);
+			i++;
+		}
+		else if (argv[i][0] != '-' && !opts->scene_path)
+			opts->scene_path = argv[i];
+		else
+			return (printf(ERR_ARGS), printf(USAGE), FALSE);
+	}
+	if ((opts->scene_path != NULL) + (opts->server != NULL)
+		+ (opts->jobs != NULL) != 1)
+		return (printf(ERR_ARGS), printf(USAGE), FALSE);
+	if (opts->resume && !opts->checkpoint)
+		opts->checkpoint = CHECKPOINT_PERIOD;
+	return (TRUE);
+}
@@ -0,0 +1,95 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** One row of 32-bit 0x00RRGGBB pixels as the RGB triplets of a PPM
+*/
+void	pack_rgb(unsigned char *dst, const char *src, int width)
+{
+	unsigned int	pixel;
+	int				x;
+
+	x = -1;
+	while (++x < width)
+	{
+		pixel = ((const unsigned int *)src)[x];
+		dst[x * 3] = (pixel >> 16) & 0xFF;
+		dst[x * 3 + 1] = (pixel >> 8) & 0xFF;
+		dst[x * 3 + 2] = pixel & 0xFF;
+	}
+}
+
+/*
+** Write a 32-bit 0x00RRGGBB buffer as a binary PPM (P6)
+*/
+int	write_ppm(const char *path, const char *addr, int width, int height)
+{
+	FILE			*file;
+	unsigned char	*row;
+	int				y;
+
+	file = fopen(path, "wb");
+	row = malloc((size_t)width * 3);
+	if (!file || !row)
+		return (free(row), file && fclose(file), printf(ERR_OUTPUT, path),
+			FALSE);
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	y = -1;
+	while (++y < height)
+	{
+		pack_rgb(row, addr + (size_t)y * width * 4, width);
+		fwrite(row, 3, width, file);
+	}
+	free(row);
+	return (fclose(file) == 0);
+}
+
+/*
+** render_init for an opts->width wide image, or with opts->compiled, the
+** render server's cached compiled scene shared instead of a fresh one
+*/
+int	render_prepare(t_render *r, const t_scene *scene, const t_options *opts,
+		int height)
+{
+	if (!opts->compiled)
+		return (render_init(r, scene, opts->width, height));
+	if (!render_setup(r, scene, opts->width, height))
+		return (FALSE);
+	r->compiled = *opts->compiled;
+	return (TRUE);
+}
+
+/* render_destroy, leaving a shared compiled scene to its owner */
+void	render_release(t_render *r, const t_options *opts)
+{
+	if (opts->compiled)
+		ft_bzero(&r->compiled, sizeof(t_compiled));
+	render_destroy(r);
+}
+
+/*
+** Headless render straight to a PPM file, no window involved. A memory
+** budget, checkpoints, worker processes or a float image go through the
+** banded writer.
+*/
+int	render_to_file(t_scene *scene, t_options *opts)
+{
+	t_render	render;
+	int			ok;
+
+	if (opts->max_memory || opts->checkpoint || opts->workers
+		|| output_is_pfm(opts->output))
+		return (render_streamed(scene, opts));
+	if (!render_prepare(&render, scene, opts, opts->height))
+		return (printf(ERR_MEMORY), FALSE);
+	render_apply_options(&render, opts);
+	render.line_length = opts->width * 4;
+	render.bytes_per_pixel = 4;
+	render.addr = malloc((size_t)opts->width * opts->height * 4);
+	if (!render.addr)
+		return (render_release(&render, opts), printf(ERR_MEMORY), FALSE);
+	ok = render_scene(&render)
+		&& write_ppm(opts->output, render.addr, opts->width, opts->height);
+	free(render.addr);
+	render_release(&render, opts);
+	return (ok);
+}
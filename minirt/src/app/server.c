@@ -0,0 +1,199 @@
+#include "../../includes/minirt_app.h"
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/*
+** Listen on a Unix socket at path. A socket left there by a server that
+** is gone is replaced, one a server still answers on is not.
+*/
+static int	listen_on(const char *path)
+{
+	struct sockaddr_un	addr;
+	struct stat			st;
+	int					fd;
+
+	ft_bzero(&addr, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if ((size_t)snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path)
+		>= sizeof(addr.sun_path))
+		return (-1);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return (-1);
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+	{
+		if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+			return (close(fd), -1);
+		unlink(path);
+	}
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+		|| listen(fd, SERVER_BACKLOG) != 0)
+		return (close(fd), -1);
+	return (fd);
+}
+
+/* Read a line into line, newline included. FALSE at the end of input. */
+static int	read_line(int fd, char *line, size_t size)
+{
+	size_t	n;
+
+	n = 0;
+	while (n + 1 < size && read(fd, line + n, 1) == 1)
+		if (line[n++] == '\n')
+			break ;
+	line[n] = '\0';
+	return (n > 0 && line[n - 1] == '\n');
+}
+
+/* Close a connection and free its slot */
+static void	client_leave(t_server *s, int slot)
+{
+	pthread_mutex_lock(&s->lock);
+	close(s->clients[slot]);
+	s->clients[slot] = -1;
+	s->active--;
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* Serve a connection's requests, a line each, until the client leaves */
+static void	*client_main(void *arg)
+{
+	t_client	*c;
+	char		line[SERVER_LINE];
+	char		reply[256];
+	int			fd;
+
+	c = (t_client *)arg;
+	fd = c->server->clients[c->slot];
+	while (read_line(fd, line, sizeof(line)))
+	{
+		server_request(c->server, line, reply, sizeof(reply));
+		if (!write_full(fd, reply, ft_strlen(reply)))
+			break ;
+	}
+	client_leave(c->server, c->slot);
+	free(c);
+	return (NULL);
+}
+
+/* Give a new connection a free slot, -1 when there is none */
+static int	take_slot(t_server *s, int fd)
+{
+	int	slot;
+
+	pthread_mutex_lock(&s->lock);
+	slot = 0;
+	while (slot < SERVER_CLIENTS && s->clients[slot] >= 0)
+		slot++;
+	if (slot < SERVER_CLIENTS)
+	{
+		s->clients[slot] = fd;
+		s->active++;
+	}
+	pthread_mutex_unlock(&s->lock);
+	if (slot == SERVER_CLIENTS)
+		return (-1);
+	return (slot);
+}
+
+/* Hand a new connection to a thread of its own, turned away when full */
+static void	accept_client(t_server *s, int fd)
+{
+	t_client	*c;
+	pthread_t	thread;
+	int			slot;
+
+	slot = take_slot(s, fd);
+	c = NULL;
+	if (slot >= 0)
+		c = malloc(sizeof(t_client));
+	if (c)
+	{
+		c->server = s;
+		c->slot = slot;
+	}
+	if (c && pthread_create(&thread, NULL, client_main, c) == 0)
+	{
+		pthread_detach(thread);
+		return ;
+	}
+	if (slot >= 0)
+		client_leave(s, slot);
+	else
+		close(fd);
+	free(c);
+}
+
+/* Stop accepting, the connections end after their current request */
+void	server_stop(t_server *s)
+{
+	__atomic_store_n(&s->stop, TRUE, __ATOMIC_RELAXED);
+	shutdown(s->fd, SHUT_RDWR);
+}
+
+/*
+** Wake the connections waiting for a request, wait for the ones still
+** rendering, then let go of the cache and the socket
+*/
+static void	server_close(t_server *s, const char *path)
+{
+	int	active;
+	int	i;
+
+	pthread_mutex_lock(&s->lock);
+	i = -1;
+	while (++i < SERVER_CLIENTS)
+		if (s->clients[i] >= 0)
+			shutdown(s->clients[i], SHUT_RD);
+	active = s->active;
+	pthread_mutex_unlock(&s->lock);
+	while (active > 0)
+	{
+		usleep(1000);
+		pthread_mutex_lock(&s->lock);
+		active = s->active;
+		pthread_mutex_unlock(&s->lock);
+	}
+	cache_clear(s);
+	pthread_mutex_destroy(&s->lock);
+	pthread_mutex_destroy(&s->load);
+	close(s->fd);
+	unlink(path);
+}
+
+/*
+** Persistent render server: parsed, built and compiled scenes stay in
+** its cache between requests, so a client only pays for them once per
+** version of the file. Each connection has a thread of its own, renders
+** of different connections run side by side. Runs until asked to
+** shut down.
+*/
+int	server_run(const t_options *opts)
+{
+	t_server	s;
+	int			fd;
+	int			i;
+
+	ft_bzero(&s, sizeof(t_server));
+	s.fd = listen_on(opts->server);
+	if (s.fd < 0)
+		return (printf(ERR_SERVER, opts->server), FALSE);
+	i = -1;
+	while (++i < SERVER_CLIENTS)
+		s.clients[i] = -1;
+	pthread_mutex_init(&s.lock, NULL);
+	pthread_mutex_init(&s.load, NULL);
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	printf("Listening on %s\n", opts->server);
+	while (!__atomic_load_n(&s.stop, __ATOMIC_RELAXED))
+	{
+		fd = accept(s.fd, NULL, NULL);
+		if (fd >= 0)
+			accept_client(&s, fd);
+	}
+	server_close(&s, opts->server);
+	return (TRUE);
+}
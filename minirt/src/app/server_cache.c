@@ -0,0 +1,185 @@
+#include "../../includes/minirt_app.h"
+#include <sys/stat.h>
+
+static void	cached_free(t_cached *entry)
+{
+	compiled_free(&entry->compiled);
+	free_scene(entry->scene);
+	free(entry->path);
+	free(entry);
+}
+
+/*
+** Take entry out of the cache, slot being where it was: it goes now
+** when nobody renders from it, with its last user otherwise
+*/
+static void	cache_drop(t_server *s, int slot)
+{
+	t_cached	*entry;
+
+	entry = s->cache[slot];
+	s->cache[slot] = NULL;
+	entry->dropped = TRUE;
+	if (entry->users == 0)
+		cached_free(entry);
+}
+
+static int	same_version(const t_version *a, const t_version *b)
+{
+	return (a->sec == b->sec && a->nsec == b->nsec && a->size == b->size
+		&& a->inode == b->inode);
+}
+
+/*
+** The cached scene read from path as it is in version, taken for a
+** request. Entries of another version of the file are dropped on the
+** way. Called with lock held.
+*/
+static t_cached	*cache_find(t_server *s, const char *path,
+		const t_version *version)
+{
+	t_cached	*found;
+	int			i;
+
+	found = NULL;
+	i = -1;
+	while (++i < SERVER_SCENES)
+	{
+		if (!s->cache[i] || ft_strncmp(s->cache[i]->path, path, PATH_MAX))
+			continue ;
+		if (!same_version(&s->cache[i]->version, version))
+			cache_drop(s, i);
+		else
+			found = s->cache[i];
+	}
+	if (found)
+	{
+		found->users++;
+		found->used = ++s->clock;
+	}
+	return (found);
+}
+
+/*
+** Put a scene just loaded in a free slot or in that of the least
+** recently used entry nobody renders from. With every entry in use it
+** stays out of the cache, dropped, for this request alone.
+*/
+static void	cache_insert(t_server *s, t_cached *entry)
+{
+	int	slot;
+	int	i;
+
+	slot = -1;
+	i = -1;
+	while (++i < SERVER_SCENES && (slot < 0 || s->cache[slot]))
+		if (!s->cache[i] || (s->cache[i]->users == 0 && (slot < 0
+					|| s->cache[i]->used < s->cache[slot]->used)))
+			slot = i;
+	entry->users = 1;
+	entry->used = ++s->clock;
+	if (slot < 0)
+	{
+		entry->dropped = TRUE;
+		return ;
+	}
+	if (s->cache[slot])
+		cache_drop(s, slot);
+	s->cache[slot] = entry;
+}
+
+/* Parse, build the hierarchy of and compile the scene at path */
+static t_cached	*cache_load(char *path, const t_version *version)
+{
+	t_cached	*entry;
+
+	entry = malloc(sizeof(t_cached));
+	if (!entry)
+		return (NULL);
+	ft_bzero(entry, sizeof(t_cached));
+	entry->version = *version;
+	entry->path = ft_strdup(path);
+	if (entry->path)
+		entry->scene = parse_scene_file_threaded(path, 0);
+	if (!entry->scene || !compile_scene(&entry->compiled, entry->scene))
+	{
+		if (entry->scene)
+			free_scene(entry->scene);
+		free(entry->path);
+		free(entry);
+		return (NULL);
+	}
+	return (entry);
+}
+
+/*
+** Load the scene at path into the cache, one scene at a time: a request
+** for a scene another one is loading waits for it and finds it cached
+*/
+static t_cached	*cache_fill(t_server *s, char *path,
+		const t_version *version, int *hit)
+{
+	t_cached	*entry;
+
+	pthread_mutex_lock(&s->load);
+	pthread_mutex_lock(&s->lock);
+	entry = cache_find(s, path, version);
+	pthread_mutex_unlock(&s->lock);
+	*hit = (entry != NULL);
+	if (!entry)
+	{
+		entry = cache_load(path, version);
+		pthread_mutex_lock(&s->lock);
+		if (entry)
+			cache_insert(s, entry);
+		pthread_mutex_unlock(&s->lock);
+	}
+	pthread_mutex_unlock(&s->load);
+	return (entry);
+}
+
+/*
+** The scene at path ready to render, from the cache when it holds the
+** file as it is now, hit telling whether it did. NULL when the file
+** cannot be read or parsed.
+*/
+t_cached	*cache_acquire(t_server *s, char *path, int *hit)
+{
+	struct stat	st;
+	t_version	version;
+	t_cached	*entry;
+
+	if (stat(path, &st) != 0)
+		return (printf(ERR_FILE), NULL);
+	version.sec = st.st_mtim.tv_sec;
+	version.nsec = st.st_mtim.tv_nsec;
+	version.size = st.st_size;
+	version.inode = st.st_ino;
+	pthread_mutex_lock(&s->lock);
+	entry = cache_find(s, path, &version);
+	pthread_mutex_unlock(&s->lock);
+	*hit = (entry != NULL);
+	if (entry)
+		return (entry);
+	return (cache_fill(s, path, &version, hit));
+}
+
+void	cache_release(t_server *s, t_cached *entry)
+{
+	pthread_mutex_lock(&s->lock);
+	entry->users--;
+	if (entry->users == 0 && entry->dropped)
+		cached_free(entry);
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* Free every cached scene, once no request is left */
+void	cache_clear(t_server *s)
+{
+	int	i;
+
+	i = -1;
+	while (++i < SERVER_SCENES)
+		if (s->cache[i])
+			cache_drop(s, i);
+}
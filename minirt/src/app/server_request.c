@@ -0,0 +1,124 @@
+#include "../../includes/minirt_app.h"
+#include <time.h>
+
+static double	now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6);
+}
+
+/*
+** Render opts from a cached scene: a copy of it carries the camera
+** overrides, the compiled scene is shared as is
+*/
+int	render_cached(const t_cached *entry, t_options *opts)
+{
+	t_scene	scene;
+
+	scene = *entry->scene;
+	options_camera(&scene, opts);
+	opts->compiled = &entry->compiled;
+	return (render_to_file(&scene, opts));
+}
+
+/* ms gets the time taken to get the scene, then to render it */
+static int	serve_render(t_server *s, t_options *opts, int *hit, double ms[2])
+{
+	t_cached	*entry;
+	double		start;
+	int			ok;
+
+	start = now_ms();
+	entry = cache_acquire(s, opts->scene_path, hit);
+	ms[0] = now_ms() - start;
+	if (!entry)
+		return (FALSE);
+	ok = render_cached(entry, opts);
+	cache_release(s, entry);
+	ms[1] = now_ms() - start - ms[0];
+	return (ok);
+}
+
+/* Split a request line into argv as main gets it, argc returned */
+int	split_request(char *line, char **argv)
+{
+	argv[0] = "minirt";
+	return (split_fields(line, " \t\r\n", argv + 1, SERVER_ARGS - 1) + 1);
+}
+
+/*
+** Options of a request: a scene and its --output at least. Worker
+** processes, benchmarks, job lists, animations and nested servers are
+** not served.
+*/
+int	request_options(int argc, char **argv, t_options *opts)
+{
+	if (argc == SERVER_ARGS || !parse_options(argc, argv, opts))
+		return (FALSE);
+	return (opts->output && !opts->server && !opts->jobs && !opts->bench
+		&& !opts->workers && !opts->animate);
+}
+
+static void	server_stats(t_server *s, char *reply, size_t size)
+{
+	double	mean;
+
+	pthread_mutex_lock(&s->lock);
+	mean = 0.0;
+	if (s->served)
+		mean = s->total_ms / s->served;
+	snprintf(reply, size, "ok served %lu cached %lu mean %.2f ms\n",
+		s->served, s->hits, mean);
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* Count a request served and log it, how it got its scene returned */
+static const char	*served(t_server *s, const t_options *opts, int hit,
+		double ms[2])
+{
+	const char	*how;
+
+	how = "loaded";
+	if (hit)
+		how = "cached";
+	pthread_mutex_lock(&s->lock);
+	s->served++;
+	s->hits += (hit != 0);
+	s->total_ms += ms[0] + ms[1];
+	pthread_mutex_unlock(&s->lock);
+	printf("%s -> %s: %s, %.2f ms\n", opts->scene_path, opts->output, how,
+		ms[0] + ms[1]);
+	return (how);
+}
+
+/*
+** One request line: the options minirt takes on the command line, or
+** shutdown, or stats. reply gets "ok" with the time spent getting the
+** scene and rendering, or "error".
+*/
+void	server_request(t_server *s, char *line, char *reply, size_t size)
+{
+	char		*argv[SERVER_ARGS];
+	t_options	opts;
+	double		ms[2];
+	int			hit;
+	int			argc;
+
+	argc = split_request(line, argv);
+	if (argc == 2 && ft_strncmp(argv[1], "shutdown", 9) == 0)
+	{
+		server_stop(s);
+		snprintf(reply, size, "ok\n");
+	}
+	else if (argc == 2 && ft_strncmp(argv[1], "stats", 6) == 0)
+		server_stats(s, reply, size);
+	else if (!request_options(argc, argv, &opts))
+		snprintf(reply, size, "error bad request\n");
+	else if (!serve_render(s, &opts, &hit, ms))
+		snprintf(reply, size, "error render failed\n");
+	else
+		snprintf(reply, size, "ok %s load %.2f render %.2f total %.2f\n",
+			served(s, &opts, hit, ms), ms[0], ms[1], ms[0] + ms[1]);
+}
@@ -0,0 +1,211 @@
+#include "../../includes/minirt_app.h"
+#include <sys/mman.h>
+
+/* Float PFM for .pfm outputs, 8-bit PPM otherwise */
+int	output_is_pfm(const char *path)
+{
+	const char	*extension;
+
+	extension = ft_strrchr(path, '.');
+	return (extension && ft_strncmp(extension, ".pfm", 5) == 0);
+}
+
+/*
+** Rows per band: as many whole tile rows as the memory budget holds,
+** so bands start on the tile grid and dither like the full image. No
+** budget, or one covering the image, renders it in one band. 0 when the
+** budget is below one tile row.
+*/
+static int	band_rows(const t_options *opts)
+{
+	size_t	pixel;
+	size_t	rows;
+
+	if (!opts->max_memory)
+		return (opts->height);
+	pixel = STREAM_PIXEL_BYTES + 3;
+	if (output_is_pfm(opts->output))
+		pixel = STREAM_PIXEL_BYTES + 3 * sizeof(float);
+	rows = opts->max_memory / ((size_t)opts->width * pixel);
+	if (rows >= (size_t)opts->height)
+		return (opts->height);
+	return ((int)(rows - rows % TILE_SIZE));
+}
+
+/* Fill in the stream's layout and format its header, PFM or PPM */
+static int	stream_header(t_stream *s, const t_options *opts, char *header,
+		size_t size)
+{
+	s->path = opts->output;
+	s->pfm = output_is_pfm(opts->output);
+	s->width = opts->width;
+	s->height = opts->height;
+	s->row_bytes = (size_t)opts->width * 3;
+	if (!s->pfm)
+		return (snprintf(header, size, "P6\n%d %d\n255\n",
+				s->width, s->height));
+	s->row_bytes *= sizeof(float);
+	return (snprintf(header, size, "PF\n%d %d\n%s\n",
+			s->width, s->height, PFM_SCALE));
+}
+
+/*
+** Create the output file at its final size, header written, for the
+** bands to be mapped into. PFM rows run bottom to top. A resumed render
+** keeps the file when it already has the right size, as kept tells;
+** one of another size holds nothing to resume and starts out empty.
+*/
+static int	stream_open(t_stream *s, const t_options *opts)
+{
+	char	header[64];
+	int		len;
+	int		flags;
+
+	len = stream_header(s, opts, header, sizeof(header));
+	s->header = len;
+	flags = O_RDWR | O_CREAT;
+	if (!opts->resume)
+		flags |= O_TRUNC;
+	s->fd = open(s->path, flags, 0644);
+	if (s->fd < 0)
+		return (printf(ERR_OUTPUT, s->path), FALSE);
+	s->kept = (lseek(s->fd, 0, SEEK_END)
+			== (off_t)(s->header + s->row_bytes * s->height));
+	if ((!s->kept && ftruncate(s->fd, 0) != 0)
+		|| pwrite(s->fd, header, len, 0) != len
+		|| ftruncate(s->fd, s->header + s->row_bytes * s->height) != 0)
+		return (close(s->fd), printf(ERR_OUTPUT, s->path), FALSE);
+	return (TRUE);
+}
+
+/* Row y of the framebuffer as linear RGB floats, exposure applied */
+static void	pfm_row(const t_framebuffer *fb, int y, char *dst)
+{
+	float	rgb[3];
+	float	scale;
+	size_t	p;
+	int		x;
+
+	scale = fb->exposure / fb->samples;
+	x = -1;
+	while (++x < fb->width)
+	{
+		p = (size_t)y * fb->width + x;
+		rgb[0] = fb->plane[0][p] * scale;
+		rgb[1] = fb->plane[1][p] * scale;
+		rgb[2] = fb->plane[2][p] * scale;
+		ft_memcpy(dst + x * sizeof(rgb), rgb, sizeof(rgb));
+	}
+}
+
+/* The rendered band's rows, dst being where its part of the file is */
+static void	fill_band(const t_stream *s, const t_render *r, char *dst)
+{
+	int	y;
+
+	y = -1;
+	while (++y < r->view.height)
+	{
+		if (s->pfm)
+			pfm_row(&r->fb, y, dst
+				+ (size_t)(r->view.height - 1 - y) * s->row_bytes);
+		else
+			pack_rgb((unsigned char *)dst + (size_t)y * s->row_bytes,
+				r->addr + (size_t)y * r->line_length, s->width);
+	}
+}
+
+/*
+** Map the part of the file the rendered band covers and write its rows
+** there. The mapping starts on the page holding the band's first byte.
+*/
+static int	write_band(const t_stream *s, const t_render *r)
+{
+	size_t	offset;
+	size_t	skip;
+	size_t	len;
+	char	*map;
+	int		y;
+
+	y = r->view.top;
+	if (s->pfm)
+		y = s->height - r->view.top - r->view.height;
+	offset = s->header + (size_t)y * s->row_bytes;
+	skip = offset % sysconf(_SC_PAGESIZE);
+	len = skip + (size_t)r->view.height * s->row_bytes;
+	map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd,
+			offset - skip);
+	if (map == MAP_FAILED)
+		return (FALSE);
+	fill_band(s, r, map + skip);
+	return (munmap(map, len) == 0);
+}
+
+static int	stream_bands(t_render *r, const t_stream *s, t_checkpoint *c,
+		t_farm *farm)
+{
+	while (r->band_top < s->height)
+	{
+		if (!render_frame_begin(r) || !checkpoint_render(c, r, farm))
+			return (FALSE);
+		render_resolve(r);
+		if (!write_band(s, r))
+			return (printf(ERR_OUTPUT, s->path), FALSE);
+		r->band_top += r->view.height;
+		if (!checkpoint_band(c, r))
+			return (FALSE);
+	}
+	return (TRUE);
+}
+
+/* Renderer for bands of rows rows of the image, packed for writing */
+static int	band_setup(t_render *r, t_scene *scene, const t_options *opts,
+		int rows)
+{
+	if (!render_prepare(r, scene, opts, rows))
+		return (printf(ERR_MEMORY), FALSE);
+	render_apply_options(r, opts);
+	r->image_height = opts->height;
+	r->line_length = opts->width * 4;
+	r->bytes_per_pixel = 4;
+	r->addr = malloc((size_t)opts->width * rows * 4);
+	if (!r->addr)
+		return (render_release(r, opts), printf(ERR_MEMORY), FALSE);
+	return (TRUE);
+}
+
+/*
+** Out-of-core headless render: the image goes down in bands of rows,
+** each written to the file as soon as it is resolved, so the image
+** never has to fit in memory, only one band of it. Checkpoints, when
+** asked for, let a render cut short resume from the last one saved;
+** worker processes, when asked for, render the tiles.
+*/
+int	render_streamed(t_scene *scene, t_options *opts)
+{
+	t_render		render;
+	t_stream		s;
+	t_checkpoint	c;
+	t_farm			farm;
+	int				ok;
+
+	if (band_rows(opts) <= 0)
+		return (printf(ERR_BAND, TILE_SIZE), FALSE);
+	if (!band_setup(&render, scene, opts, band_rows(opts)))
+		return (FALSE);
+	ft_bzero(&farm, sizeof(t_farm));
+	ok = checkpoint_init(&c, &render, opts)
+		&& farm_start(&farm, &render, opts) && stream_open(&s, opts);
+	if (ok)
+	{
+		c.fd = s.fd;
+		ok = checkpoint_load(&c, &render, s.kept)
+			&& stream_bands(&render, &s, &c, &farm);
+		ok = (close(s.fd) == 0 && ok);
+	}
+	farm_stop(&farm);
+	checkpoint_finish(&c, &render, ok);
+	free(render.addr);
+	render_release(&render, opts);
+	return (ok);
+}
@@ -0,0 +1,106 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** A frame was presented in full: a preview is followed by the full
+** frame, a full frame becomes the history of the next ones. The frames
+** refreshing a reprojected view follow until none is due.
+*/
+static void	frame_done(t_vars *vars)
+{
+	t_render	*r;
+
+	r = &vars->render;
+	if (r->preview > 1)
+	{
+		render_async_restart(r);
+		return ;
+	}
+	render_commit(r);
+	vars->controls.since = 0;
+	if (vars->controls.refresh > 0)
+		render_async_restart(r);
+}
+
+/*
+** Called by mlx between events: show the tiles finished since the last
+** call. A cancelled frame is replaced once its workers are gone, after
+** the pending edits are applied. Otherwise sleep a little so an idle
+** window does not spin.
+*/
+static int	loop_hook(t_vars *vars)
+{
+	t_render	*r;
+	int			copied;
+
+	r = &vars->render;
+	copied = render_async_present(r);
+	if (copied > 0)
+		mlx_put_image_to_window(vars->mlx, vars->win, vars->img->img, 0, 0);
+	if (r->async.restart && render_async_idle(r))
+	{
+		controls_apply(vars);
+		if (!render_async_start(r))
+			mlx_loop_end(vars->mlx);
+	}
+	else if (render_async_idle(r) && render_async_finished(r))
+		frame_done(vars);
+	if (copied == 0)
+		usleep(RENDER_POLL_US);
+	return (0);
+}
+
+static int	close_hook(t_vars *vars)
+{
+	mlx_loop_end(vars->mlx);
+	return (0);
+}
+
+/*
+** Render into a private back buffer on the worker threads while mlx
+** keeps handling events; the loop hook copies finished tiles into the
+** window image. Input hooks only edit the camera, queue object moves
+** and raise flags, none of them waits for the renderer.
+*/
+void	window_start(t_vars *vars, t_scene *scene, const t_options *opts)
+{
+	vars->scene = scene;
+	ft_bzero(&vars->controls, sizeof(t_controls));
+	vars->controls.selected = -1;
+	vars->controls.light = scene->light;
+	vars->controls.ambient = scene->ambient;
+	if (!render_init(&vars->render, scene, WIDTH, HEIGHT))
+		error_exit(ERR_MEMORY);
+	render_apply_options(&vars->render, opts);
+	if (!render_gbuffer_init(&vars->render))
+		error_exit(ERR_MEMORY);
+	vars->back = malloc((size_t)vars->img->line_length * HEIGHT);
+	if (!vars->back)
+		error_exit(ERR_MEMORY);
+	vars->render.addr = vars->back;
+	vars->render.line_length = vars->img->line_length;
+	vars->render.bytes_per_pixel = vars->img->bits_per_pixel / 8;
+	vars->render.endian = vars->img->endian;
+	vars->render.async.front = vars->img->addr;
+	if (!render_async_start(&vars->render))
+		error_exit(ERR_MEMORY);
+	mlx_loop_hook(vars->mlx, loop_hook, vars);
+	mlx_hook(vars->win, EVENT_KEY_PRESS, 1L << 0, controls_key, vars);
+	mlx_hook(vars->win, EVENT_BUTTON_PRESS, 1L << 2, controls_press, vars);
+	mlx_hook(vars->win, EVENT_BUTTON_RELEASE, 1L << 3, controls_release,
+		vars);
+	mlx_hook(vars->win, EVENT_MOTION, 1L << 6, controls_motion, vars);
+	mlx_hook(vars->win, EVENT_DESTROY, 1L << 17, close_hook, vars);
+}
+
+/* After mlx_loop returns: stop the workers, then release everything */
+void	window_close(t_vars *vars)
+{
+	render_async_stop(&vars->render);
+	render_destroy(&vars->render);
+	free(vars->back);
+	mlx_destroy_image(vars->mlx, vars->img->img);
+	free(vars->img);
+	mlx_destroy_window(vars->mlx, vars->win);
+	mlx_destroy_display(vars->mlx);
+	free(vars->mlx);
+}
@@ -1,13 +1,33 @@
 #include "../../includes/minirt_app.h"
 
-int	add_object_to_scene(t_scene *scene, int type, void *object_data)
+/*
+** Objects live in a heap array that doubles when full, so scene size is
+** only bounded by memory.
+*/
+static int	grow_objects(t_scene *scene)
 {
-	if (scene->num_objects >= MAX_OBJECTS)
-	{
-		printf("Error: Maximum number of objects reached (%d)\n",
-			MAX_OBJECTS);
+	t_object	*objects;
+	int			capacity;
+
+	capacity = scene->capacity * 2;
+	if (capacity < OBJECTS_INITIAL_CAPACITY)
+		capacity = OBJECTS_INITIAL_CAPACITY;
+	objects = malloc(sizeof(t_object) * capacity);
+	if (!objects)
 		return (FALSE);
-	}
+	if (scene->num_objects > 0)
+		ft_memcpy(objects, scene->objects,
+			sizeof(t_object) * scene->num_objects);
+	free(scene->objects);
+	scene->objects = objects;
+	scene->capacity = capacity;
+	return (TRUE);
+}
+
+int	add_object_to_scene(t_scene *scene, int type, void *object_data)
+{
+	if (scene->num_objects == scene->capacity && !grow_objects(scene))
+		return (parse_print(ERR_MEMORY), FALSE);
 	scene->objects[scene->num_objects].type = type;
 	if (type == SPHERE)
 		scene->objects[scene->num_objects].data.sphere = *(t_sphere *)object_data;
@@ -18,11 +38,26 @@ int	add_object_to_scene(t_scene *scene, int type, void *object_data)
 			*(t_cylinder *)object_data;
 	else if (type == CONE)
 		scene->objects[scene->num_objects].data.cone = *(t_cone *)object_data;
+	else if (type == BOX)
+		scene->objects[scene->num_objects].data.box = *(t_box *)object_data;
+	else if (type == QUAD)
+		scene->objects[scene->num_objects].data.quad = *(t_quad *)object_data;
+	else if (type == DISC)
+		scene->objects[scene->num_objects].data.disc = *(t_disc *)object_data;
 	else
 	{
-		printf("Error: Unknown object type %d\n", type);
+		parse_print("Error: Unknown object type %d\n", type);
 		return (FALSE);
 	}
 	scene->num_objects++;
 	return (TRUE);
 }
+
+void	free_scene(t_scene *scene)
+{
+	if (!scene)
+		return ;
+	free(scene->objects);
+	bvh_free(scene->bvh);
+	free(scene);
+}
@@ -0,0 +1,65 @@
+#include "../../includes/minirt_app.h"
+#include "../../includes/parser.h"
+#include <math.h>
+
+/*
+** The position of line in double when it is the C line. FALSE for any
+** other line, and for a C line that does not read, left to the parser.
+*/
+static int	camera_position(const char *start, size_t len, double pos[3])
+{
+	char	line[256];
+	char	*tokens[2];
+	char	*xyz[3];
+
+	while (len && (*start == ' ' || *start == '\t'))
+	{
+		start++;
+		len--;
+	}
+	if (len < 2 || start[0] != 'C' || (start[1] != ' ' && start[1] != '\t')
+		|| len >= sizeof(line))
+		return (FALSE);
+	ft_memcpy(line, start, len);
+	line[len] = '\0';
+	return (split_fields(line, " \t\r", tokens, 2) == 2
+		&& split_fields(tokens[1], ",", xyz, 3) == 3
+		&& parse_double(xyz[0], &pos[0]) && parse_double(xyz[1], &pos[1])
+		&& parse_double(xyz[2], &pos[2]));
+}
+
+/*
+** Far scenes in the float build are parsed relative to their camera:
+** every position is read in double and has base taken off before it is
+** narrowed to t_real, so rays start near the origin where float is
+** precise. base is the first C line's position rounded to even units,
+** which keeps plane checkerboards in phase. It stays zero in the double
+** build and for a camera within POSITION_FAR of the origin.
+*/
+void	scene_find_base(const char *map, size_t size, double base[3])
+{
+	const char	*p;
+	const char	*nl;
+	double		pos[3];
+	int			i;
+
+	ft_bzero(base, sizeof(double) * 3);
+	if (sizeof(t_real) >= sizeof(double))
+		return ;
+	p = map;
+	while (p < map + size)
+	{
+		nl = memchr(p, '\n', map + size - p);
+		if (!nl)
+			nl = map + size;
+		if (camera_position(p, nl - p, pos))
+			break ;
+		p = nl + 1;
+	}
+	if (p >= map + size || sqrt(pos[0] * pos[0] + pos[1] * pos[1]
+			+ pos[2] * pos[2]) <= POSITION_FAR)
+		return ;
+	i = -1;
+	while (++i < 3)
+		base[i] = 2.0 * round(pos[i] / 2.0);
+}
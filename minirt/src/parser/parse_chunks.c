@@ -0,0 +1,190 @@
+#include "../../includes/minirt_app.h"
+#include "../../includes/parser.h"
+#include <pthread.h>
+
+/*
+** Cut [map, map + size) into n slices of roughly equal size, each one
+** ending just after a newline so that no line straddles two chunks.
+** Every chunk's scene starts on the file's base.
+*/
+void	chunk_split(t_parse_chunk *chunks, const char *map, size_t size, int n)
+{
+	const char	*prev;
+	const char	*cut;
+	const char	*nl;
+	double		base[3];
+	int			i;
+
+	scene_find_base(map, size, base);
+	prev = map;
+	i = -1;
+	while (++i < n)
+	{
+		ft_bzero(&chunks[i], sizeof(t_parse_chunk));
+		ft_memcpy(chunks[i].scene.base, base, sizeof(base));
+		chunks[i].start = prev;
+		cut = map + size * (i + 1) / n;
+		if (cut < prev)
+			cut = prev;
+		if (i == n - 1)
+			cut = map + size;
+		else if (cut < map + size)
+		{
+			nl = memchr(cut, '\n', map + size - cut);
+			cut = map + size;
+			if (nl)
+				cut = nl + 1;
+		}
+		chunks[i].end = cut;
+		prev = cut;
+	}
+}
+
+void	*chunk_count_lines(void *arg)
+{
+	t_parse_chunk	*chunk;
+	const char		*p;
+	const char		*nl;
+
+	chunk = arg;
+	p = chunk->start;
+	while (p < chunk->end)
+	{
+		nl = memchr(p, '\n', chunk->end - p);
+		if (!nl)
+			break ;
+		chunk->num_lines++;
+		p = nl + 1;
+	}
+	if (p < chunk->end)
+		chunk->num_lines++;
+	return (NULL);
+}
+
+static void	note_error(t_parse_chunk *chunk, int line)
+{
+	int	seen;
+
+	chunk->error_line = line;
+	seen = __atomic_load_n(chunk->first_error, __ATOMIC_RELAXED);
+	while (line < seen && !__atomic_compare_exchange_n(chunk->first_error,
+			&seen, line, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+/*
+** Record the line that gave the chunk its first A, C or L, and how much
+** had been logged before it, for the merge to check across chunks
+*/
+static void	note_unique(t_parse_chunk *chunk, int line, size_t mark)
+{
+	if (chunk->scene.has_ambient && !chunk->ambient_line)
+	{
+		chunk->ambient_line = line;
+		chunk->marks[0] = mark;
+	}
+	if (chunk->scene.has_camera && !chunk->camera_line)
+	{
+		chunk->camera_line = line;
+		chunk->marks[1] = mark;
+	}
+	if (chunk->scene.has_light && !chunk->light_line)
+	{
+		chunk->light_line = line;
+		chunk->marks[2] = mark;
+	}
+}
+
+/*
+** The mapping is read-only, so each line is copied into the arena to be
+** tokenised in place. Everything the line needed goes with the reset.
+*/
+static int	parse_line(t_parser *parser, t_parse_chunk *chunk,
+		const char *start, size_t len)
+{
+	size_t	mark;
+	size_t	logged;
+	char	*line;
+	int		ok;
+
+	logged = chunk->log_len;
+	mark = arena_mark(parser->arena);
+	line = arena_alloc(parser->arena, len + 1);
+	if (!line)
+		return (parser->line_count++, parse_print(ERR_MEMORY), FALSE);
+	ft_memcpy(line, start, len);
+	line[len] = '\0';
+	ok = process_scene_line(parser, &chunk->scene, line);
+	arena_reset(parser->arena, mark);
+	parser->line = NULL;
+	parser->tokens = NULL;
+	if (ok)
+		note_unique(chunk, parser->line_count, logged);
+	return (ok);
+}
+
+/*
+** Parse one chunk into its private scene, line by line. Sequential
+** parsing is the single-chunk case of the same code. A chunk stops at
+** its first error, or as soon as another chunk has failed on an earlier
+** line since nothing after that line can change the outcome. Messages
+** go to the chunk's log, objects to the BVH stream as they accumulate.
+*/
+void	*chunk_parse(void *arg)
+{
+	t_parse_chunk	*chunk;
+	t_parser		parser;
+	t_arena			arena;
+	const char		*p;
+	const char		*nl;
+
+	chunk = arg;
+	ft_bzero(&parser, sizeof(t_parser));
+	parse_log_to(chunk);
+	if (!arena_init(&arena, ARENA_PARSE_SIZE, FALSE))
+		return (parse_print(ERR_MEMORY), parse_log_to(NULL),
+			note_error(chunk, chunk->first_line + 1), NULL);
+	parser.arena = &arena;
+	parser.line_count = chunk->first_line;
+	parser.stream = chunk->stream;
+	parser.chunk = chunk->index;
+	p = chunk->start;
+	while (p < chunk->end && parser.line_count
+		< __atomic_load_n(chunk->first_error, __ATOMIC_RELAXED))
+	{
+		nl = memchr(p, '\n', chunk->end - p);
+		if (!nl)
+			nl = chunk->end;
+		if (!parse_line(&parser, chunk, p, nl - p))
+			return (parse_log_to(NULL), arena_destroy(&arena),
+				note_error(chunk, parser.line_count), NULL);
+		stream_objects(&parser, &chunk->scene, FALSE);
+		p = nl + 1;
+	}
+	stream_objects(&parser, &chunk->scene, TRUE);
+	return (parse_log_to(NULL), arena_destroy(&arena), NULL);
+}
+
+/*
+** Run fn over every chunk, chunk 0 on the calling thread. A chunk whose
+** thread could not be started is simply run inline afterwards.
+*/
+void	chunks_run(t_parse_chunk *chunks, int n, void *(*fn)(void *))
+{
+	pthread_t	threads[MAX_PARSE_THREADS];
+	int			started[MAX_PARSE_THREADS];
+	int			i;
+
+	i = 0;
+	while (++i < n)
+		started[i] = (pthread_create(&threads[i], NULL, fn, &chunks[i]) == 0);
+	fn(&chunks[0]);
+	i = 0;
+	while (++i < n)
+	{
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			fn(&chunks[i]);
+	}
+}
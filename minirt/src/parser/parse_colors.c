@@ -3,16 +3,15 @@
 
 int	parse_color(char *str, t_color3 *color)
 {
-	char	**tokens;
+	char	*tokens[3];
 	int		success;
 	int		r;
 	int		g;
 	int		b;
 
 	success = TRUE;
-	tokens = ft_split(str, ",");
-	if (!tokens || !tokens[0] || !tokens[1] || !tokens[2])
-		return (printf(ERR_COLOR_FORMAT), free_tokens(tokens), FALSE);
+	if (split_fields(str, ",", tokens, 3) < 3)
+		return (parse_print(ERR_COLOR_FORMAT), FALSE);
 	r = ft_atoi(tokens[0]);
 	g = ft_atoi(tokens[1]);
 	b = ft_atoi(tokens[2]);
@@ -25,7 +24,6 @@ int	parse_color(char *str, t_color3 *color)
 		color->z = b / 255.0;
 	}
 	else
-		printf(ERR_COLOR_FORMAT);
-	free_tokens(tokens);
+		parse_print(ERR_COLOR_FORMAT);
 	return (success);
 }
@@ -1,31 +1,39 @@
 #include "../../includes/minirt_app.h"
 #include "../../includes/parser.h"
 
+/*
+** Strict decimal reader: [+-]digits[.digits]. The sign applies to the
+** whole value (so "-0.5" stays negative) and anything left over after
+** the number is rejected.
+*/
 int	parse_double(char *str, double *value)
 {
-	char	*dot;
 	double	result;
-	char	*frac_str;
-	int		divisor;
-	int		j;
+	double	frac;
+	double	divisor;
+	int		sign;
+	int		digits;
 
 	if (!str || !value)
 		return (FALSE);
-	dot = ft_strchr(str, '.');
+	sign = 1;
+	if (*str == '-' || *str == '+')
+		if (*str++ == '-')
+			sign = -1;
 	result = 0.0;
-	if (dot)
-	{
-		*dot = '\0';
-		result = (double)ft_atoi(str);
-		frac_str = dot + 1;
-		divisor = 1;
-		j = -1;
-		while (frac_str[++j])
-			divisor *= 10;
-		result += (double)ft_atoi(frac_str) / divisor;
-	}
-	else
-		result = (double)ft_atoi(str);
-	*value = result;
+	digits = 0;
+	while (ft_isdigit(*str) && ++digits)
+		result = result * 10.0 + (*str++ - '0');
+	frac = 0.0;
+	divisor = 1.0;
+	if (*str == '.')
+		while (ft_isdigit(*++str) && ++digits)
+		{
+			frac = frac * 10.0 + (*str - '0');
+			divisor *= 10.0;
+		}
+	if (digits == 0 || *str)
+		return (FALSE);
+	*value = sign * (result + frac / divisor);
 	return (TRUE);
 }
@@ -15,19 +15,19 @@ int	parse_ambient(char **tokens, t_scene *scene)
 	double		ratio;
 
 	if (!tokens[1] || !tokens[2])
-		return (printf(ERR_AMBIENT_FORMAT),
-			printf(FMT_AMBIENT_EXPECTED), FALSE);
+		return (parse_print(ERR_AMBIENT_FORMAT),
+			parse_print(FMT_AMBIENT_EXPECTED), FALSE);
 	if (scene->has_ambient)
-		return (printf(ERR_AMBIENT_ALREADY_DEFINED), FALSE);
+		return (parse_print(ERR_AMBIENT_ALREADY_DEFINED), FALSE);
 	if (!parse_double(tokens[1], &ratio))
 		return (FALSE);
 	if (ratio < 0.0 || ratio > 1.0)
-		return (printf(ERR_AMBIENT_RATIO_RANGE), FALSE);
+		return (parse_print(ERR_AMBIENT_RATIO_RANGE), FALSE);
 	if (!parse_color(tokens[2], &color))
-		return (printf(ERR_AMBIENT_COLOR_INVALID), FALSE);
+		return (parse_print(ERR_AMBIENT_COLOR_INVALID), FALSE);
 	if (tokens[3])
-		return (printf(ERR_AMBIENT_FORMAT),
-			printf(ERR_AMBIENT_TOO_MANY_ARGS), FALSE);
+		return (parse_print(ERR_AMBIENT_FORMAT),
+			parse_print(ERR_AMBIENT_TOO_MANY_ARGS), FALSE);
 	scene->ambient.ratio = ratio;
 	scene->ambient.color = color;
 	scene->has_ambient = TRUE;
@@ -41,21 +41,21 @@ int	parse_light(char **tokens, t_scene *scene)
 	double		brightness;
 
 	if (!tokens[1] || !tokens[2] || !tokens[3])
-		return (printf(ERR_LIGHT_FORMAT),
-			printf(FMT_LIGHT_EXPECTED), FALSE);
+		return (parse_print(ERR_LIGHT_FORMAT),
+			parse_print(FMT_LIGHT_EXPECTED), FALSE);
 	if (scene->has_light)
-		return (printf(ERR_LIGHT_ALREADY_DEFINED), FALSE);
-	if (!parse_vector(tokens[1], &position))
+		return (parse_print(ERR_LIGHT_ALREADY_DEFINED), FALSE);
+	if (!parse_position(tokens[1], &position))
 		return (FALSE);
 	if (!parse_double(tokens[2], &brightness))
 		return (FALSE);
 	if (brightness < 0.0 || brightness > 1.0)
-		return (printf(ERR_LIGHT_BRIGHTNESS_RANGE), FALSE);
+		return (parse_print(ERR_LIGHT_BRIGHTNESS_RANGE), FALSE);
 	if (!parse_color(tokens[3], &color))
-		return (printf(ERR_LIGHT_COLOR_INVALID), FALSE);
+		return (parse_print(ERR_LIGHT_COLOR_INVALID), FALSE);
 	if (tokens[4])
-		return (printf(ERR_LIGHT_FORMAT),
-			printf(ERR_LIGHT_TOO_MANY_ARGS), FALSE);
+		return (parse_print(ERR_LIGHT_FORMAT),
+			parse_print(ERR_LIGHT_TOO_MANY_ARGS), FALSE);
 	scene->light.position = position;
 	scene->light.brightness = brightness;
 	scene->light.color = color;
@@ -71,17 +71,17 @@ int	parse_sphere(char **tokens, t_scene *scene)
 	double		diameter;
 
 	if (!tokens[1] || !tokens[2] || !tokens[3])
-		return (printf(ERR_SPHERE_FORMAT),
-			printf(FMT_SPHERE_EXPECTED), FALSE);
-	if (!parse_vector(tokens[1], &center))
+		return (parse_print(ERR_SPHERE_FORMAT),
+			parse_print(FMT_SPHERE_EXPECTED), FALSE);
+	if (!parse_position(tokens[1], &center))
 		return (FALSE);
 	if (!parse_double(tokens[2], &diameter))
 		return (FALSE);
 	if (!tokens[3] || !parse_color(tokens[3], &color))
-		return (printf(ERR_SPHERE_COLOR_INVALID), FALSE);
+		return (parse_print(ERR_SPHERE_COLOR_INVALID), FALSE);
 	if (tokens[4])
-		return (printf(ERR_SPHERE_FORMAT),
-			printf(ERR_SPHERE_TOO_MANY_ARGS), FALSE);
+		return (parse_print(ERR_SPHERE_FORMAT),
+			parse_print(ERR_SPHERE_TOO_MANY_ARGS), FALSE);
 	sphere.center = center;
 	sphere.diameter = diameter;
 	sphere.color = color;
@@ -97,17 +97,17 @@ static int	parse_plane_params(char **tokens, t_vec3 *point,
 			t_vec3 *normal, t_color3 *color)
 {
 	if (!tokens[1] || !tokens[2] || !tokens[3])
-		return (printf(ERR_PLANE_FORMAT),
-			printf(FMT_PLANE_EXPECTED), FALSE);
-	if (!parse_vector(tokens[1], point) || !parse_vector(tokens[2], normal))
+		return (parse_print(ERR_PLANE_FORMAT),
+			parse_print(FMT_PLANE_EXPECTED), FALSE);
+	if (!parse_position(tokens[1], point) || !parse_vector(tokens[2], normal))
 		return (FALSE);
 	if (!validate_plane_normal(normal))
 		return (FALSE);
 	if (!tokens[3] || !parse_color(tokens[3], color))
-		return (printf(ERR_PLANE_COLOR_INVALID), FALSE);
+		return (parse_print(ERR_PLANE_COLOR_INVALID), FALSE);
 	if (tokens[4])
-		return (printf(ERR_PLANE_FORMAT),
-			printf(ERR_PLANE_TOO_MANY_ARGS), FALSE);
+		return (parse_print(ERR_PLANE_FORMAT),
+			parse_print(ERR_PLANE_TOO_MANY_ARGS), FALSE);
 	return (TRUE);
 }
 
@@ -133,9 +133,9 @@ static int	parse_cylinder_params(char **tokens, t_cylinder *cylinder,
 			double *diameter, double *height, t_color3 *color)
 {
 	if (!tokens[1] || !tokens[2] || !tokens[3] || !tokens[4])
-		return (printf(ERR_CYLINDER_FORMAT),
-			printf(FMT_CYLINDER_EXPECTED), FALSE);
-	if (!parse_vector(tokens[1], &cylinder->center))
+		return (parse_print(ERR_CYLINDER_FORMAT),
+			parse_print(FMT_CYLINDER_EXPECTED), FALSE);
+	if (!parse_position(tokens[1], &cylinder->center))
 		return (FALSE);
 	if (!parse_vector(tokens[2], &cylinder->axis))
 		return (FALSE);
@@ -146,19 +146,19 @@ static int	parse_cylinder_params(char **tokens, t_cylinder *cylinder,
 		if (!parse_double(tokens[4], height))
 			return (FALSE);
 		if (!tokens[5] || !parse_color(tokens[5], color))
-			return (printf(ERR_CYLINDER_COLOR_INVALID), FALSE);
+			return (parse_print(ERR_CYLINDER_COLOR_INVALID), FALSE);
 		if (tokens[6])
-			return (printf(ERR_CYLINDER_FORMAT),
-				printf(ERR_CYLINDER_TOO_MANY_ARGS), FALSE);
+			return (parse_print(ERR_CYLINDER_FORMAT),
+				parse_print(ERR_CYLINDER_TOO_MANY_ARGS), FALSE);
 	}
 	else
 	{
 		*height = *diameter;
 		if (!tokens[4] || !parse_color(tokens[4], color))
-			return (printf(ERR_CYLINDER_COLOR_INVALID), FALSE);
+			return (parse_print(ERR_CYLINDER_COLOR_INVALID), FALSE);
 		if (tokens[5])
-			return (printf(ERR_CYLINDER_FORMAT),
-				printf(ERR_CYLINDER_TOO_MANY_ARGS), FALSE);
+			return (parse_print(ERR_CYLINDER_FORMAT),
+				parse_print(ERR_CYLINDER_TOO_MANY_ARGS), FALSE);
 	}
 	return (TRUE);
 }
@@ -192,12 +192,13 @@ int	parse_cone(char **tokens, t_scene *scene)
 	t_color3	color;
 
 	if (!tokens[1] || !tokens[2] || !tokens[3] || !tokens[4] || !tokens[5])
-		return (printf(ERR_CONE_FORMAT),
-			printf(FMT_CONE_EXPECTED), FALSE);
-	if (!parse_vector(tokens[1], &cone.vertex) || !parse_vector(tokens[2], &cone.axis))
+		return (parse_print(ERR_CONE_FORMAT),
+			parse_print(FMT_CONE_EXPECTED), FALSE);
+	if (!parse_position(tokens[1], &cone.vertex)
+		|| !parse_vector(tokens[2], &cone.axis))
 		return (FALSE);
 	if (!validate_non_zero_vector(cone.axis))
-		return (printf(ERR_CONE_FORMAT), FALSE);
+		return (parse_print(ERR_CONE_FORMAT), FALSE);
 	if (!parse_double(tokens[3], &angle) || !parse_double(tokens[4], &height))
 		return (FALSE);
 	if (angle > 0 && angle <= 180)
@@ -205,10 +206,10 @@ int	parse_cone(char **tokens, t_scene *scene)
 	if (!validate_cone_dimensions(angle, height))
 		return (FALSE);
 	if (!tokens[5] || !parse_color(tokens[5], &color))
-		return (printf(ERR_CONE_COLOR_INVALID), FALSE);
+		return (parse_print(ERR_CONE_COLOR_INVALID), FALSE);
 	if (tokens[6])
-		return (printf(ERR_CONE_FORMAT),
-			printf(ERR_CONE_TOO_MANY_ARGS), FALSE);
+		return (parse_print(ERR_CONE_FORMAT),
+			parse_print(ERR_CONE_TOO_MANY_ARGS), FALSE);
 	cone.axis = vec3_normalize(cone.axis);
 	cone.angle = angle;
 	cone.height = height;
@@ -226,21 +227,24 @@ int	parse_camera(char **tokens, t_scene *scene)
 	double	fov;
 
 	if (!tokens[1] || !tokens[2] || !tokens[3] || tokens[4])
-		return (printf(ERR_CAMERA_FORMAT),
-			printf(FMT_CAMERA_EXPECTED), FALSE);
-	if (!parse_vector(tokens[1], &position) || !parse_vector(tokens[2],
+		return (parse_print(ERR_CAMERA_FORMAT),
+			parse_print(FMT_CAMERA_EXPECTED), FALSE);
+	if (scene->has_camera)
+		return (parse_print(ERR_CAMERA_ALREADY_DEFINED), FALSE);
+	if (!parse_position(tokens[1], &position) || !parse_vector(tokens[2],
 			&orientation) || !parse_double(tokens[3], &fov))
 		return (FALSE);
 	if (!validate_non_zero_vector(orientation))
-		return (printf(ERR_CAMERA_FORMAT), FALSE);
+		return (parse_print(ERR_CAMERA_FORMAT), FALSE);
 	orientation = vec3_normalize(orientation);
 	if (!validate_normalized_vector(orientation))
-		return (printf(ERR_CAMERA_FORMAT), FALSE);
+		return (parse_print(ERR_CAMERA_FORMAT), FALSE);
 	if (fov < 0.0 || fov > 180.0)
-		return (printf(ERR_CAMERA_FORMAT),
-			printf(ERR_CAMERA_FOV_RANGE), FALSE);
+		return (parse_print(ERR_CAMERA_FORMAT),
+			parse_print(ERR_CAMERA_FOV_RANGE), FALSE);
 	scene->camera.position = position;
 	scene->camera.orientation = orientation;
 	scene->camera.fov = fov;
+	scene->has_camera = TRUE;
 	return (TRUE);
 }
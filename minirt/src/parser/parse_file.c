@@ -12,14 +12,14 @@ int	validate_extension_and_permission(const char *filename, t_scene *scene)
 	if (!extension || ft_strncmp(extension, ".rt", 3) != 0)
 	{
 		printf(ERR_FILE_EXTENSION);
-		free(scene);
+		free_scene(scene);
 		return (-1);
 	}
 	fd = open(filename, O_RDONLY);
 	if (fd == -1)
 	{
 		printf(ERR_FILE_ACCESS, filename);
-		free(scene);
+		free_scene(scene);
 		return (-1);
 	}
 	return (fd);
@@ -64,10 +64,20 @@ int	dispatch_parse_token(char **tokens, t_scene *scene)
 			return (parse_cylinder(tokens, scene));
 		else if (tokens[0][0] == 'c' && tokens[0][1] == 'n')
 			return (parse_cone(tokens, scene));
+		else if (tokens[0][0] == 'b' && tokens[0][1] == 'x')
+			return (parse_box(tokens, scene));
+		else if (tokens[0][0] == 'q' && tokens[0][1] == 'd')
+			return (parse_quad(tokens, scene));
+		else if (tokens[0][0] == 'd' && tokens[0][1] == 'c')
+			return (parse_disc(tokens, scene));
 	}
-	return (FALSE);
+	return (-1);
 }
 
+/*
+** Tokens are carved out of line in place, with the pointer array taken
+** from the parser's arena. The caller owns line and resets the arena.
+*/
 int	process_scene_line(t_parser *parser, t_scene *scene, char *line)
 {
 	int	parse_result;
@@ -75,67 +85,33 @@ int	process_scene_line(t_parser *parser, t_scene *scene, char *line)
 	parser->line_count++;
 	parser->line = line;
 	if (is_empty_line(line))
-	{
-		free(line);
-		parser->line = NULL;
 		return (1);
-	}
-	parser->tokens = ft_split(line, " \t\n\r");
-	if (!parser->tokens || !parser->tokens[0] || parser->tokens[0][0] == '#')
-	{
-		free(line);
-		free_tokens(parser->tokens);
-		parser->tokens = NULL;
-		parser->line = NULL;
+	parser->tokens = split_line(parser->arena, line, " \t\n\r");
+	if (!parser->tokens)
+		return (parse_print(ERR_MEMORY), 0);
+	if (!parser->tokens[0] || parser->tokens[0][0] == '#')
 		return (1);
-	}
 	parse_result = dispatch_parse_token(parser->tokens, scene);
-	if (!parse_result)
-	{
-		if (parser->tokens && parser->tokens[0])
-		{
-			printf("Error: Unknown identifier: ");
-			printf("%s", parser->tokens[0]);
-			printf("\n");
-		}
-		else
-			printf("Error: Invalid line format\n");
-	}
-	free(line);
-	free_tokens(parser->tokens);
-	parser->tokens = NULL;
-	parser->line = NULL;
-	return (parse_result);
+	if (parse_result < 0)
+		parse_print(ERR_UNKNOWN_IDENTIFIER, parser->line_count,
+			parser->tokens[0]);
+	else if (!parse_result)
+		parse_print(ERR_LINE_ELEMENT, parser->line_count, parser->tokens[0]);
+	return (parse_result > 0);
 }
 
-t_scene	*parse_scene_file(char *filename)
+/*
+** Hand the objects parsed since the last call to the BVH stream, once a
+** full batch has accumulated or unconditionally when flushing.
+*/
+void	stream_objects(t_parser *parser, t_scene *scene, int flush)
 {
-	t_scene		*scene;
-	t_parser	parser;
-	int			fd;
-	char		*line;
-	int			result;
+	int	count;
 
-	scene = (t_scene *)malloc(sizeof(t_scene));
-	if (!scene)
-		return (NULL);
-	ft_bzero(scene, 0);
-	ft_bzero(&parser, 0);
-	fd = validate_extension_and_permission(filename, scene);
-	if (fd == -1)
-		return (NULL);
-	line = get_next_line(fd);
-	while (line != NULL)
-	{
-		result = process_scene_line(&parser, scene, line);
-		if (result == 0)
-			return (close(fd), free(scene), NULL);
-		line = get_next_line(fd);
-	}
-	close(fd);
-	if (parser.line_count == 0)
-		return (printf("Error: Empty file\n"), free(scene), NULL);
-	if (!validate_scene(scene))
-		return (free(scene), NULL);
-	return (scene);
+	count = scene->num_objects - parser->pushed;
+	if (!parser->stream || count == 0 || (count < BVH_BATCH_SIZE && !flush))
+		return ;
+	bvh_stream_push(parser->stream, parser->chunk,
+		scene->objects + parser->pushed, count);
+	parser->pushed = scene->num_objects;
 }
@@ -0,0 +1,75 @@
+#include "../../includes/minirt_app.h"
+#include "../../includes/parser.h"
+#include <stdarg.h>
+
+static __thread t_parse_chunk	*g_log;
+static __thread double			*g_base;
+
+/*
+** Send this thread's parser messages to chunk's log, NULL to stdout.
+** Its positions are then read on the base of chunk's scene.
+*/
+void	parse_log_to(t_parse_chunk *chunk)
+{
+	g_log = chunk;
+	g_base = NULL;
+	if (chunk)
+		g_base = chunk->scene.base;
+}
+
+/* Take this thread's positions relative to base, NULL for none */
+void	parse_base_to(double *base)
+{
+	g_base = base;
+}
+
+double	*parse_base(void)
+{
+	return (g_base);
+}
+
+/* Make room for len more bytes and the '\0' in the chunk's log */
+static int	log_reserve(t_parse_chunk *chunk, size_t len)
+{
+	char	*log;
+	size_t	size;
+
+	if (chunk->log_len + len < chunk->log_size)
+		return (TRUE);
+	size = chunk->log_size * 2 + len + 256;
+	log = malloc(size);
+	if (!log)
+		return (FALSE);
+	if (chunk->log_len)
+		ft_memcpy(log, chunk->log, chunk->log_len);
+	free(chunk->log);
+	chunk->log = log;
+	chunk->log_size = size;
+	return (TRUE);
+}
+
+/*
+** printf for the parser. While a chunk is being parsed its messages are
+** kept in its log instead, so chunks parsed side by side report in file
+** order once merged. Printed on the spot if the log cannot grow.
+*/
+int	parse_print(const char *format, ...)
+{
+	va_list	args;
+	va_list	copy;
+	int		len;
+
+	va_start(args, format);
+	va_copy(copy, args);
+	len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (!g_log || len < 0 || !log_reserve(g_log, len))
+		len = vprintf(format, args);
+	else
+	{
+		vsnprintf(g_log->log + g_log->log_len, len + 1, format, args);
+		g_log->log_len += len;
+	}
+	va_end(args);
+	return (len);
+}
@@ -0,0 +1,209 @@
+#include "../../includes/minirt_app.h"
+#include "../../includes/parser.h"
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+** Earliest A/C/L line of the chunk that repeats an element already
+** merged from an earlier chunk, 0 if none. kind receives its index in
+** A, C, L order.
+*/
+static int	duplicate_line(const t_scene *scene, const t_parse_chunk *chunk,
+		int *kind)
+{
+	int	lines[3];
+	int	best;
+	int	i;
+
+	lines[0] = chunk->ambient_line * (scene->has_ambient != 0);
+	lines[1] = chunk->camera_line * (scene->has_camera != 0);
+	lines[2] = chunk->light_line * (scene->has_light != 0);
+	best = 0;
+	*kind = 0;
+	i = -1;
+	while (++i < 3)
+	{
+		if (lines[i] && (!best || lines[i] < best))
+		{
+			best = lines[i];
+			*kind = i;
+		}
+	}
+	return (best);
+}
+
+static void	take_unique(t_scene *scene, const t_scene *part)
+{
+	if (part->has_ambient)
+	{
+		scene->ambient = part->ambient;
+		scene->has_ambient = TRUE;
+	}
+	if (part->has_camera)
+	{
+		scene->camera = part->camera;
+		scene->has_camera = TRUE;
+	}
+	if (part->has_light)
+	{
+		scene->light = part->light;
+		scene->has_light = TRUE;
+	}
+}
+
+static int	append_objects(t_scene *scene, const t_parse_chunk *chunks,
+		int n, int total)
+{
+	int	i;
+
+	if (total == 0)
+		return (TRUE);
+	scene->objects = malloc(sizeof(t_object) * total);
+	if (!scene->objects)
+		return (FALSE);
+	scene->capacity = total;
+	i = -1;
+	while (++i < n)
+	{
+		bvh_stream_place(chunks[i].stream, i, scene->num_objects);
+		ft_memcpy(scene->objects + scene->num_objects, chunks[i].scene.objects,
+			sizeof(t_object) * chunks[i].scene.num_objects);
+		scene->num_objects += chunks[i].scene.num_objects;
+	}
+	return (TRUE);
+}
+
+/*
+** Fold the chunks together in file order. The unique-element check that
+** each chunk could only do locally is redone across chunks here, and
+** whichever failure comes first in the file, a cross-chunk duplicate or
+** a chunk's own error, decides the result. Chunk logs are printed up to
+** that failure, so the output is the sequential parser's.
+*/
+static t_scene	*merge_chunks(t_parse_chunk *chunks, int n)
+{
+	static const char	*names[3] = {"A", "C", "L"};
+	static const char	*errors[3] = {ERR_AMBIENT_ALREADY_DEFINED,
+		ERR_CAMERA_ALREADY_DEFINED, ERR_LIGHT_ALREADY_DEFINED};
+	t_scene				*scene;
+	int					total;
+	int					kind;
+	int					dup;
+	int					i;
+
+	scene = malloc(sizeof(t_scene));
+	if (!scene)
+		return (printf(ERR_MEMORY), NULL);
+	ft_bzero(scene, sizeof(t_scene));
+	ft_memcpy(scene->base, chunks[0].scene.base, sizeof(scene->base));
+	total = 0;
+	i = -1;
+	while (++i < n && chunks[i].first_line < *chunks[i].first_error)
+	{
+		dup = duplicate_line(scene, &chunks[i], &kind);
+		if (dup && dup < *chunks[i].first_error)
+			return (fwrite(chunks[i].log, 1, chunks[i].marks[kind], stdout),
+				printf("%s", errors[kind]), printf(ERR_LINE_ELEMENT, dup,
+					names[kind]), free_scene(scene), NULL);
+		fwrite(chunks[i].log, 1, chunks[i].log_len, stdout);
+		take_unique(scene, &chunks[i].scene);
+		total += chunks[i].scene.num_objects;
+	}
+	if (*chunks[0].first_error != INT_MAX)
+		return (free_scene(scene), NULL);
+	if (!append_objects(scene, chunks, n, total))
+		return (printf(ERR_MEMORY), free_scene(scene), NULL);
+	return (scene);
+}
+
+/*
+** Two passes over the mapped file: count lines per chunk so every chunk
+** knows the global number of its first line, then parse all chunks at
+** once into private scenes, all on the same base, and merge them.
+*/
+static t_scene	*parse_chunks(const char *map, size_t size, int n,
+		t_bvh_stream *stream)
+{
+	t_parse_chunk	chunks[MAX_PARSE_THREADS];
+	t_scene			*scene;
+	int				first_error;
+	int				i;
+
+	first_error = INT_MAX;
+	chunk_split(chunks, map, size, n);
+	i = -1;
+	while (++i < n)
+	{
+		chunks[i].first_error = &first_error;
+		chunks[i].stream = stream;
+		chunks[i].index = i;
+	}
+	chunks_run(chunks, n, chunk_count_lines);
+	i = 0;
+	while (++i < n)
+		chunks[i].first_line = chunks[i - 1].first_line
+			+ chunks[i - 1].num_lines;
+	chunks_run(chunks, n, chunk_parse);
+	scene = merge_chunks(chunks, n);
+	i = -1;
+	while (++i < n)
+	{
+		free(chunks[i].scene.objects);
+		free(chunks[i].log);
+	}
+	return (scene);
+}
+
+static t_scene	*parse_mapped(int fd, size_t size, int num_threads,
+		t_bvh_stream *stream)
+{
+	t_scene	*scene;
+	char	*map;
+
+	map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return (printf(ERR_MEMORY), NULL);
+	scene = parse_chunks(map, size, num_threads, stream);
+	munmap(map, size);
+	if (scene && !validate_scene(scene))
+		return (free_scene(scene), NULL);
+	return (scene);
+}
+
+/*
+** num_threads 0 picks a count automatically: one per online CPU for
+** files of PARSE_PARALLEL_MIN_SIZE bytes or more, a single chunk below
+** that. 1 always reads sequentially. Either way objects stream to the
+** BVH builders while parsing, so only linking the treelets is left once
+** the last line is read.
+*/
+t_scene	*parse_scene_file_threaded(char *filename, int num_threads)
+{
+	struct stat		st;
+	t_bvh_stream	*stream;
+	t_scene			*scene;
+	t_bvh			*bvh;
+	int				fd;
+
+	fd = validate_extension_and_permission(filename, NULL);
+	if (fd == -1)
+		return (NULL);
+	if (fstat(fd, &st) == -1 || st.st_size == 0)
+		return (close(fd), printf("Error: Empty file\n"), NULL);
+	if (num_threads == 0 && st.st_size >= PARSE_PARALLEL_MIN_SIZE)
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_threads > MAX_PARSE_THREADS)
+		num_threads = MAX_PARSE_THREADS;
+	if (num_threads < 1)
+		num_threads = 1;
+	stream = bvh_stream_start();
+	scene = parse_mapped(fd, st.st_size, num_threads, stream);
+	bvh = bvh_stream_finish(stream);
+	if (!scene)
+		return (bvh_free(bvh), NULL);
+	scene->bvh = bvh;
+	return (scene);
+}
@@ -0,0 +1,130 @@
+#include "../../includes/minirt_app.h"
+#include <stdio.h>
+
+/*
+** Center, direction and color shared by boxes, quads and discs, the
+** direction normalized like cone axes. size is the number of size
+** tokens between the direction and the color.
+*/
+static int	parse_flat_params(char **tokens, int size, t_vec3 v[2],
+			t_color3 *color)
+{
+	int	i;
+
+	i = 0;
+	while (i < size + 4 && tokens[i])
+		i++;
+	if (i < size + 4 || tokens[size + 4])
+		return (FALSE);
+	if (!parse_position(tokens[1], &v[0]) || !parse_vector(tokens[2], &v[1])
+		|| !validate_non_zero_vector(v[1]))
+		return (FALSE);
+	v[1] = vec3_normalize(v[1]);
+	return (parse_color(tokens[size + 3], color));
+}
+
+/*
+** Optional angle in degrees after the color of a box or quad, count
+** being the number of tokens before it. The angle is taken off the line
+** so the fixed fields are checked as usual, 0 when there is none.
+*/
+static int	take_angle(char **tokens, int count, double *angle)
+{
+	int	i;
+
+	*angle = 0.0;
+	i = 0;
+	while (i <= count && tokens[i])
+		i++;
+	if (i != count + 1 || tokens[count + 1])
+		return (TRUE);
+	if (!parse_double(tokens[count], angle))
+		return (FALSE);
+	tokens[count] = NULL;
+	return (TRUE);
+}
+
+/*
+** Width direction of a box or quad: the first vector vec3_frame gives
+** around the unit direction dir, turned about dir by degrees
+*/
+static t_vec3	flat_side(t_vec3 dir, double degrees)
+{
+	t_vec3	side;
+	t_vec3	other;
+
+	vec3_frame(dir, &side, &other);
+	return (vec3_rotate_around_axis(side, dir, degrees * M_PI / 180.0));
+}
+
+int	parse_box(char **tokens, t_scene *scene)
+{
+	t_box		box;
+	t_vec3		v[2];
+	double		angle;
+
+	if (!take_angle(tokens, 5, &angle)
+		|| !parse_flat_params(tokens, 1, v, &box.color))
+		return (parse_print(ERR_BOX_FORMAT), parse_print(FMT_BOX_EXPECTED),
+			FALSE);
+	if (!parse_vector(tokens[3], &box.size))
+		return (FALSE);
+	if (box.size.x <= 0.0 || box.size.y <= 0.0 || box.size.z <= 0.0)
+		return (parse_print(ERR_BOX_FORMAT), parse_print(ERR_BOX_SIZE_POSITIVE),
+			FALSE);
+	validate_position(v[0], "Box");
+	box.center = v[0];
+	box.axis = v[1];
+	box.side = flat_side(v[1], angle);
+	box.material = create_simple_material(box.color);
+	return (add_object_to_scene(scene, BOX, &box));
+}
+
+int	parse_quad(char **tokens, t_scene *scene)
+{
+	t_quad		quad;
+	t_vec3		v[2];
+	double		width;
+	double		height;
+	double		angle;
+
+	if (!take_angle(tokens, 6, &angle)
+		|| !parse_flat_params(tokens, 2, v, &quad.color))
+		return (parse_print(ERR_QUAD_FORMAT), parse_print(FMT_QUAD_EXPECTED),
+			FALSE);
+	if (!parse_double(tokens[3], &width) || !parse_double(tokens[4], &height))
+		return (FALSE);
+	if (width <= 0.0 || height <= 0.0)
+		return (parse_print(ERR_QUAD_FORMAT),
+			parse_print(ERR_QUAD_SIZE_POSITIVE), FALSE);
+	validate_position(v[0], "Quad");
+	quad.center = v[0];
+	quad.normal = v[1];
+	quad.side = flat_side(v[1], angle);
+	quad.width = width;
+	quad.height = height;
+	quad.material = create_simple_material(quad.color);
+	return (add_object_to_scene(scene, QUAD, &quad));
+}
+
+int	parse_disc(char **tokens, t_scene *scene)
+{
+	t_disc		disc;
+	t_vec3		v[2];
+	double		diameter;
+
+	if (!parse_flat_params(tokens, 1, v, &disc.color))
+		return (parse_print(ERR_DISC_FORMAT), parse_print(FMT_DISC_EXPECTED),
+			FALSE);
+	if (!parse_double(tokens[3], &diameter))
+		return (FALSE);
+	if (diameter <= 0.0)
+		return (parse_print(ERR_DISC_FORMAT),
+			parse_print(ERR_DISC_DIAMETER_POSITIVE), FALSE);
+	validate_position(v[0], "Disc");
+	disc.center = v[0];
+	disc.normal = v[1];
+	disc.diameter = diameter;
+	disc.material = create_simple_material(disc.color);
+	return (add_object_to_scene(scene, DISC, &disc));
+}
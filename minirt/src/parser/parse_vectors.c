@@ -3,45 +3,62 @@
 #include <math.h>
 #include <stdlib.h>
 
-static int	parse_vector_tokens(char **tokens, t_vec3 *vec)
+/* Read x,y,z in double, less base when given, and only then narrow */
+static int	parse_vector_tokens(char **tokens, const double *base,
+		t_vec3 *vec)
 {
-	double	x;
-	double	y;
-	double	z;
+	double	v[3];
 
-	if (!parse_double(tokens[0], &x) || !parse_double(tokens[1], &y)
-		|| !parse_double(tokens[2], &z))
+	if (!parse_double(tokens[0], &v[0]) || !parse_double(tokens[1], &v[1])
+		|| !parse_double(tokens[2], &v[2]))
 		return (FALSE);
-	vec->x = x;
-	vec->y = y;
-	vec->z = z;
+	if (base)
+	{
+		v[0] -= base[0];
+		v[1] -= base[1];
+		v[2] -= base[2];
+	}
+	vec->x = v[0];
+	vec->y = v[1];
+	vec->z = v[2];
 	return (TRUE);
 }
 
 int	parse_vector(char *str, t_vec3 *vec)
 {
-	char	**tokens;
-	int		success;
+	char	*tokens[3];
 
-	tokens = ft_split(str, ",");
-	if (!tokens || !tokens[0] || !tokens[1] || !tokens[2])
+	if (split_fields(str, ",", tokens, 3) < 3
+		|| !parse_vector_tokens(tokens, NULL, vec))
 	{
-		printf(ERR_VECTOR_FORMAT);
-		free_tokens(tokens);
+		parse_print(ERR_VECTOR_FORMAT);
 		return (FALSE);
 	}
-	success = parse_vector_tokens(tokens, vec);
-	if (!success)
-		printf(ERR_VECTOR_FORMAT);
-	free_tokens(tokens);
-	return (success);
+	return (TRUE);
+}
+
+/*
+** A point of the scene rather than a direction: relative to the base of
+** the scene being parsed, see scene_find_base
+*/
+int	parse_position(char *str, t_vec3 *pos)
+{
+	char	*tokens[3];
+
+	if (split_fields(str, ",", tokens, 3) < 3
+		|| !parse_vector_tokens(tokens, parse_base(), pos))
+	{
+		parse_print(ERR_VECTOR_FORMAT);
+		return (FALSE);
+	}
+	return (TRUE);
 }
 
 int	validate_non_zero_vector(t_vec3 vec)
 {
 	if (vec.x == 0.0 && vec.y == 0.0 && vec.z == 0.0)
 	{
-		printf(ERR_VECTOR_FORMAT);
+		parse_print(ERR_VECTOR_FORMAT);
 		return (FALSE);
 	}
 	return (TRUE);
@@ -54,7 +71,7 @@ int	validate_normalized_vector(t_vec3 vec)
 	length = vec3_length(vec);
 	if (fabs(length - 1.0) > 0.0001)
 	{
-		printf(ERR_VECTOR_FORMAT);
+		parse_print(ERR_VECTOR_FORMAT);
 		return (FALSE);
 	}
 	return (TRUE);
@@ -1,21 +1,65 @@
 #include "../../includes/minirt_app.h"
 
+static int	is_separator(char c, const char *set)
+{
+	while (*set)
+	{
+		if (*set++ == c)
+			return (TRUE);
+	}
+	return (FALSE);
+}
+
 /**
- * Free an array of strings
+ * Split str in place, ft_split style: separator runs become '\0' and
+ * pointers to the first max non-empty fields are stored, the rest of
+ * the string is left untouched.
  *
- * @param tokens Array of strings to free
+ * @return Number of fields found, at most max
  */
-void	free_tokens(char **tokens)
+int	split_fields(char *str, const char *set, char **fields, int max)
 {
-	int	i;
+	int	count;
 
-	if (!tokens)
-		return ;
-	i = 0;
-	while (tokens[i])
+	count = 0;
+	while (*str && count < max)
+	{
+		while (*str && is_separator(*str, set))
+			*str++ = '\0';
+		if (!*str)
+			break ;
+		fields[count++] = str;
+		while (*str && !is_separator(*str, set))
+			str++;
+	}
+	if (*str && is_separator(*str, set))
+		*str = '\0';
+	return (count);
+}
+
+/**
+ * Split a mutable line in place into a NULL-terminated token array taken
+ * from the arena. Nothing needs freeing, resetting the arena drops it.
+ *
+ * @return Token array, or NULL when the arena is exhausted
+ */
+char	**split_line(t_arena *arena, char *line, const char *set)
+{
+	char	**tokens;
+	char	*p;
+	int		count;
+
+	count = 0;
+	p = line;
+	while (*p)
 	{
-		free(tokens[i]);
-		i++;
+		if (!is_separator(*p, set) && (p == line || is_separator(p[-1], set)))
+			count++;
+		p++;
 	}
-	free(tokens);
+	tokens = arena_alloc(arena, sizeof(char *) * (count + 1));
+	if (!tokens)
+		return (NULL);
+	tokens[split_fields(line, set, tokens, count)] = NULL;
+	return (tokens);
 }
@@ -5,28 +5,28 @@
 int	validate_plane_normal(t_vec3 *normal)
 {
 	if (!validate_non_zero_vector(*normal))
-		return (printf(ERR_PLANE_FORMAT), FALSE);
+		return (parse_print(ERR_PLANE_FORMAT), FALSE);
 	*normal = vec3_normalize(*normal);
 	if (!validate_normalized_vector(*normal))
-		return (printf(ERR_PLANE_FORMAT), FALSE);
+		return (parse_print(ERR_PLANE_FORMAT), FALSE);
 	return (TRUE);
 }
 
 int	validate_cone_dimensions(double angle, double height)
 {
 	if (angle <= 0.0 || height <= 0.0)
-		return (printf(ERR_CONE_FORMAT),
-			printf(ERR_CONE_DIMS_POSITIVE), FALSE);
+		return (parse_print(ERR_CONE_FORMAT),
+			parse_print(ERR_CONE_DIMS_POSITIVE), FALSE);
 	if (angle > M_PI)
-		return (printf(ERR_CONE_FORMAT),
-			printf(ERR_CONE_ANGLE_TOO_LARGE), FALSE);
+		return (parse_print(ERR_CONE_FORMAT),
+			parse_print(ERR_CONE_ANGLE_TOO_LARGE), FALSE);
 	if (angle < 0.01)
 	{
-		printf(WARN_CONE_ANGLE_SMALL, angle);
+		parse_print(WARN_CONE_ANGLE_SMALL, angle);
 	}
 	if (height < 0.001)
 	{
-		printf(WARN_CONE_HEIGHT_SMALL, height);
+		parse_print(WARN_CONE_HEIGHT_SMALL, height);
 	}
 	return (TRUE);
 }
@@ -36,12 +36,12 @@ int	validate_sphere(t_sphere *sphere)
 	if (!validate_position(sphere->center, "Sphere"))
 		return (FALSE);
 	if (sphere->diameter <= 0.0)
-		return (printf(ERR_SPHERE_FORMAT),
-			printf(ERR_SPHERE_DIAMETER_POSITIVE), FALSE);
+		return (parse_print(ERR_SPHERE_FORMAT),
+			parse_print(ERR_SPHERE_DIAMETER_POSITIVE), FALSE);
 	if (sphere->diameter < 0.001)
-		printf(WARN_SPHERE_DIAMETER_SMALL);
+		parse_print(WARN_SPHERE_DIAMETER_SMALL);
 	else if (sphere->diameter < 0.1)
-		printf(WARN_SPHERE_DIAMETER_VERY_SMALL);
+		parse_print(WARN_SPHERE_DIAMETER_VERY_SMALL);
 	return (TRUE);
 }
 
@@ -50,20 +50,20 @@ int	validate_cylinder(t_cylinder *cylinder)
 	if (!validate_position(cylinder->center, "Cylinder"))
 		return (FALSE);
 	if (!validate_non_zero_vector(cylinder->axis))
-		return (printf(ERR_CYLINDER_AXIS_ZERO), FALSE);
+		return (parse_print(ERR_CYLINDER_AXIS_ZERO), FALSE);
 	if (!validate_normalized_vector(cylinder->axis))
-		return (printf(ERR_CYLINDER_AXIS_NOT_NORMALIZED), FALSE);
+		return (parse_print(ERR_CYLINDER_AXIS_NOT_NORMALIZED), FALSE);
 	if (cylinder->diameter <= 0.0 || cylinder->height <= 0.0)
-		return (printf(ERR_CYLINDER_FORMAT),
-			printf(ERR_CYLINDER_DIMS_POSITIVE), FALSE);
+		return (parse_print(ERR_CYLINDER_FORMAT),
+			parse_print(ERR_CYLINDER_DIMS_POSITIVE), FALSE);
 	if (cylinder->height < 0)
-		return (printf(ERR_CYLINDER_HEIGHT_NEGATIVE), FALSE);
+		return (parse_print(ERR_CYLINDER_HEIGHT_NEGATIVE), FALSE);
 	if (cylinder->diameter < 0.001)
-		printf(WARN_CYLINDER_DIAMETER_SMALL);
+		parse_print(WARN_CYLINDER_DIAMETER_SMALL);
 	if (cylinder->height < 0.001)
-		printf(WARN_CYLINDER_HEIGHT_SMALL);
+		parse_print(WARN_CYLINDER_HEIGHT_SMALL);
 	if (cylinder->diameter < 0.1 || cylinder->height < 0.1)
-		printf(WARN_CYLINDER_DIMS_SMALL);
+		parse_print(WARN_CYLINDER_DIMS_SMALL);
 	return (TRUE);
 }
 
@@ -72,18 +72,39 @@ int	validate_plane(t_plane *plane)
 	if (!validate_position(plane->point, "Plane"))
 		return (FALSE);
 	if (!validate_non_zero_vector(plane->normal))
-		return (printf(ERR_PLANE_NORMAL_ZERO), FALSE);
+		return (parse_print(ERR_PLANE_NORMAL_ZERO), FALSE);
 	if (!validate_normalized_vector(plane->normal))
-		return (printf(ERR_PLANE_NORMAL_NOT_NORMALIZED), FALSE);
+		return (parse_print(ERR_PLANE_NORMAL_NOT_NORMALIZED), FALSE);
 	return (TRUE);
 }
 
+/*
+** Warn about a position far from the scene's origin. Once the float
+** build has moved the base to a far camera that is the camera, and the
+** position is reported back in world coordinates.
+*/
 int	validate_position(t_point3 pos, const char *type)
 {
-	double	dist;
+	const double	*base;
+	const char		*from;
+	double			world[3];
 
-	dist = sqrt(pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
-	if (dist > 1000.0)
-		printf(WARN_POSITION_FAR, type, pos.x, pos.y, pos.z);
+	if (vec3_length(pos) <= POSITION_FAR)
+		return (1);
+	base = parse_base();
+	from = "origin";
+	world[0] = pos.x;
+	world[1] = pos.y;
+	world[2] = pos.z;
+	if (base && (base[0] || base[1] || base[2]))
+	{
+		from = "camera";
+		world[0] += base[0];
+		world[1] += base[1];
+		world[2] += base[2];
+	}
+	parse_print(WARN_POSITION_FAR, type, from, world[0], world[1], world[2]);
+	if (sizeof(t_real) < sizeof(double))
+		parse_print(WARN_POSITION_FLOAT);
 	return (1);
 }
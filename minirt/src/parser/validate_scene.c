@@ -41,11 +41,17 @@ static int	validate_scene_objects(t_scene *scene)
 	return (TRUE);
 }
 
+/* Positions are checked on the scene's base, as they were parsed */
 int	validate_scene(t_scene *scene)
 {
+	int	ok;
+
 	if (!validate_scene_basic(scene))
 		return (FALSE);
-	return (validate_scene_objects(scene));
+	parse_base_to(scene->base);
+	ok = validate_scene_objects(scene);
+	parse_base_to(NULL);
+	return (ok);
 }
 
 int	validate_scene_rendering(t_scene *scene)
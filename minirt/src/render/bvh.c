@@ -0,0 +1,115 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Copy a finished treelet into the shared arrays, shifting node links by
+** the nodes already there and turning batch-local object indices into
+** scene indices. Returns the relocated root.
+*/
+static int	append_batch(t_bvh *bvh, const t_bvh_batch *b, int base)
+{
+	t_bvh_node	node;
+	int			i;
+
+	i = -1;
+	while (++i < b->num_nodes)
+	{
+		node = b->nodes[i];
+		if (node.count)
+			node.first += bvh->num_items;
+		else
+		{
+			node.left += bvh->num_nodes;
+			node.right += bvh->num_nodes;
+		}
+		bvh->nodes[bvh->num_nodes + i] = node;
+	}
+	i = -1;
+	while (++i < b->num_items)
+		bvh->items[bvh->num_items + i] = base + b->items[i];
+	i = -1;
+	while (++i < b->num_unbounded)
+		bvh->unbounded[bvh->num_unbounded++] = base + b->unbounded[i];
+	bvh->num_items += b->num_items;
+	bvh->num_nodes += b->num_nodes;
+	return (bvh->num_nodes - b->num_nodes);
+}
+
+static t_bvh	*bvh_alloc(const t_bvh_stream *stream, int *num_roots)
+{
+	const t_bvh_batch	*b;
+	t_bvh				*bvh;
+	int					sizes[3];
+
+	ft_bzero(sizes, sizeof(sizes));
+	*num_roots = 0;
+	b = stream->done;
+	while (b)
+	{
+		sizes[0] += b->num_nodes + (b->num_nodes > 0);
+		sizes[1] += b->num_items;
+		sizes[2] += b->num_unbounded;
+		*num_roots += (b->num_nodes > 0);
+		b = b->next;
+	}
+	bvh = malloc(sizeof(t_bvh));
+	if (!bvh)
+		return (NULL);
+	ft_bzero(bvh, sizeof(t_bvh));
+	bvh->nodes = malloc(sizeof(t_bvh_node) * (sizes[0] + 1));
+	bvh->items = malloc(sizeof(int) * (sizes[1] + 1));
+	bvh->unbounded = malloc(sizeof(int) * (sizes[2] + 1));
+	if (!bvh->nodes || !bvh->items || !bvh->unbounded)
+		return (bvh_free(bvh), NULL);
+	return (bvh);
+}
+
+t_bvh	*bvh_assemble(const t_bvh_stream *stream)
+{
+	const t_bvh_batch	*b;
+	t_bvh				*bvh;
+	t_arena				scratch;
+	int					*roots;
+	int					num_roots;
+	int					root;
+
+	bvh = bvh_alloc(stream, &num_roots);
+	if (!bvh || !arena_init(&scratch, ARENA_SCRATCH_SIZE, FALSE))
+		return (bvh_free(bvh), NULL);
+	roots = arena_alloc(&scratch, sizeof(int) * (num_roots + 1));
+	if (!roots)
+		return (arena_destroy(&scratch), bvh_free(bvh), NULL);
+	num_roots = 0;
+	b = stream->done;
+	while (b)
+	{
+		root = append_batch(bvh, b, stream->chunk_base[b->chunk] + b->first);
+		if (b->num_nodes > 0)
+			roots[num_roots++] = root;
+		b = b->next;
+	}
+	if (!bvh_build_top(bvh, roots, num_roots, &scratch))
+		return (arena_destroy(&scratch), bvh_free(bvh), NULL);
+	arena_destroy(&scratch);
+	return (bvh);
+}
+
+void	bvh_free_batch(t_bvh_batch *batch)
+{
+	if (!batch)
+		return ;
+	free(batch->objects);
+	free(batch->nodes);
+	free(batch->items);
+	free(batch->unbounded);
+	free(batch);
+}
+
+void	bvh_free(t_bvh *bvh)
+{
+	if (!bvh)
+		return ;
+	free(bvh->nodes);
+	free(bvh->items);
+	free(bvh->unbounded);
+	free(bvh);
+}
@@ -0,0 +1,286 @@
+#include "../../includes/minirt_app.h"
+
+/* Spread the low 10 bits of v so that two zero bits follow each one */
+static unsigned int	expand_bits(unsigned int v)
+{
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return (v);
+}
+
+/*
+** 30-bit Morton code of p quantised to a 1024^3 grid spanning [lo, hi]
+*/
+static unsigned int	morton_code(t_vec3 p, t_vec3 lo, t_vec3 hi)
+{
+	t_real	q[3];
+	t_real	extent[3];
+	int		i;
+
+	extent[0] = hi.x - lo.x;
+	extent[1] = hi.y - lo.y;
+	extent[2] = hi.z - lo.z;
+	q[0] = p.x - lo.x;
+	q[1] = p.y - lo.y;
+	q[2] = p.z - lo.z;
+	i = -1;
+	while (++i < 3)
+	{
+		if (extent[i] > 0)
+			q[i] = q[i] / extent[i] * 1023;
+		else
+			q[i] = 0;
+	}
+	return ((expand_bits((unsigned int)q[0]) << 2)
+		| (expand_bits((unsigned int)q[1]) << 1)
+		| expand_bits((unsigned int)q[2]));
+}
+
+static void	box_grow(t_vec3 *lo, t_vec3 *hi, t_vec3 plo, t_vec3 phi)
+{
+	lo->x = fmin(lo->x, plo.x);
+	lo->y = fmin(lo->y, plo.y);
+	lo->z = fmin(lo->z, plo.z);
+	hi->x = fmax(hi->x, phi.x);
+	hi->y = fmax(hi->y, phi.y);
+	hi->z = fmax(hi->z, phi.z);
+}
+
+/*
+** Stable LSD radix sort of items by their 30-bit codes, 10 bits a pass.
+** The ping-pong buffers come from scratch and are left there.
+*/
+int	bvh_morton_sort(unsigned int *codes, int *items, int n, t_arena *scratch)
+{
+	unsigned int	*tmp_codes;
+	int				*tmp_items;
+	int				count[1025];
+	int				shift;
+	int				i;
+
+	tmp_codes = arena_alloc(scratch, sizeof(unsigned int) * n);
+	tmp_items = arena_alloc(scratch, sizeof(int) * n);
+	if (!tmp_codes || !tmp_items)
+		return (FALSE);
+	shift = 0;
+	while (shift < 30)
+	{
+		ft_bzero(count, sizeof(count));
+		i = -1;
+		while (++i < n)
+			count[((codes[i] >> shift) & 1023) + 1]++;
+		i = 0;
+		while (++i < 1025)
+			count[i] += count[i - 1];
+		i = -1;
+		while (++i < n)
+		{
+			tmp_codes[count[(codes[i] >> shift) & 1023]] = codes[i];
+			tmp_items[count[(codes[i] >> shift) & 1023]++] = items[i];
+		}
+		ft_memcpy(codes, tmp_codes, sizeof(unsigned int) * n);
+		ft_memcpy(items, tmp_items, sizeof(int) * n);
+		shift += 10;
+	}
+	return (TRUE);
+}
+
+/*
+** Median split over the Morton-sorted items. bounds holds the box of
+** batch object i at [2 * i, 2 * i + 1].
+*/
+static int	build_node(t_bvh_batch *b, const t_vec3 *bounds, int start,
+		int count)
+{
+	t_bvh_node	*node;
+	int			index;
+	int			i;
+
+	index = b->num_nodes++;
+	node = &b->nodes[index];
+	ft_bzero(node, sizeof(t_bvh_node));
+	if (count <= BVH_LEAF_SIZE)
+	{
+		node->first = start;
+		node->count = count;
+		node->lo = bounds[2 * b->items[start]];
+		node->hi = bounds[2 * b->items[start] + 1];
+		i = start;
+		while (++i < start + count)
+			box_grow(&node->lo, &node->hi, bounds[2 * b->items[i]],
+				bounds[2 * b->items[i] + 1]);
+		return (index);
+	}
+	node->left = build_node(b, bounds, start, count / 2);
+	node->right = build_node(b, bounds, start + count / 2,
+			count - count / 2);
+	node->lo = b->nodes[node->left].lo;
+	node->hi = b->nodes[node->left].hi;
+	box_grow(&node->lo, &node->hi, b->nodes[node->right].lo,
+		b->nodes[node->right].hi);
+	return (index);
+}
+
+static void	batch_bounds(t_bvh_batch *b, t_vec3 *bounds, t_vec3 centroid[2])
+{
+	t_bsphere	bs;
+	t_real		r;
+	int			i;
+
+	centroid[0] = vec3_create(INFINITY, INFINITY, INFINITY);
+	centroid[1] = vec3_create(-INFINITY, -INFINITY, -INFINITY);
+	i = -1;
+	while (++i < b->count)
+	{
+		if (!object_bounds(&b->objects[i], &bs))
+		{
+			b->unbounded[b->num_unbounded++] = i;
+			continue ;
+		}
+		r = bs.radius + RT_EPSILON;
+		bounds[2 * i] = vec3_sub(bs.center, vec3_create(r, r, r));
+		bounds[2 * i + 1] = vec3_add(bs.center, vec3_create(r, r, r));
+		box_grow(&centroid[0], &centroid[1], bs.center, bs.center);
+		b->items[b->num_items++] = i;
+	}
+}
+
+/*
+** Bounds and Morton codes for every object of the batch, then a treelet
+** over the bounded ones rooted at node 0. Temporaries live in the
+** builder's scratch arena, reset on return. The object copies are
+** released once their bounds are known.
+*/
+int	bvh_build_batch(t_bvh_batch *b, t_arena *scratch)
+{
+	t_vec3			*bounds;
+	unsigned int	*codes;
+	t_vec3			centroid[2];
+	size_t			mark;
+	int				ok;
+	int				i;
+
+	mark = arena_mark(scratch);
+	bounds = arena_alloc(scratch, sizeof(t_vec3) * 2 * b->count);
+	codes = arena_alloc(scratch, sizeof(unsigned int) * b->count);
+	b->items = malloc(sizeof(int) * b->count);
+	b->unbounded = malloc(sizeof(int) * b->count);
+	b->nodes = malloc(sizeof(t_bvh_node) * 2 * b->count);
+	ok = (bounds && codes && b->items && b->unbounded && b->nodes);
+	if (ok)
+	{
+		batch_bounds(b, bounds, centroid);
+		i = -1;
+		while (++i < b->num_items)
+			codes[i] = morton_code(vec3_mult(vec3_add(bounds[2 * b->items[i]],
+							bounds[2 * b->items[i] + 1]), 0.5),
+					centroid[0], centroid[1]);
+		ok = bvh_morton_sort(codes, b->items, b->num_items, scratch);
+		if (ok && b->num_items > 0)
+			build_node(b, bounds, 0, b->num_items);
+	}
+	arena_reset(scratch, mark);
+	free(b->objects);
+	b->objects = NULL;
+	return (ok);
+}
+
+static int	top_node(t_bvh *bvh, const int *roots, int count)
+{
+	t_bvh_node	*node;
+	int			index;
+
+	if (count == 1)
+		return (roots[0]);
+	index = bvh->num_nodes++;
+	node = &bvh->nodes[index];
+	ft_bzero(node, sizeof(t_bvh_node));
+	node->left = top_node(bvh, roots, count / 2);
+	node->right = top_node(bvh, roots + count / 2, count - count / 2);
+	node->lo = bvh->nodes[node->left].lo;
+	node->hi = bvh->nodes[node->left].hi;
+	box_grow(&node->lo, &node->hi, bvh->nodes[node->right].lo,
+		bvh->nodes[node->right].hi);
+	return (index);
+}
+
+/*
+** Link the treelet roots already stored in bvh->nodes under a top level
+** built the same way, Morton order then median splits. The node array
+** must have room for count - 1 more nodes.
+*/
+int	bvh_build_top(t_bvh *bvh, int *roots, int count, t_arena *scratch)
+{
+	unsigned int	*codes;
+	t_vec3			centroid[2];
+	t_vec3			c;
+	int				i;
+
+	bvh->root = -1;
+	if (count == 0)
+		return (TRUE);
+	codes = arena_alloc(scratch, sizeof(unsigned int) * count);
+	if (!codes)
+		return (FALSE);
+	centroid[0] = vec3_create(INFINITY, INFINITY, INFINITY);
+	centroid[1] = vec3_create(-INFINITY, -INFINITY, -INFINITY);
+	i = -1;
+	while (++i < count)
+	{
+		c = vec3_mult(vec3_add(bvh->nodes[roots[i]].lo,
+					bvh->nodes[roots[i]].hi), 0.5);
+		box_grow(&centroid[0], &centroid[1], c, c);
+	}
+	i = -1;
+	while (++i < count)
+		codes[i] = morton_code(vec3_mult(vec3_add(bvh->nodes[roots[i]].lo,
+						bvh->nodes[roots[i]].hi), 0.5), centroid[0], centroid[1]);
+	if (!bvh_morton_sort(codes, roots, count, scratch))
+		return (FALSE);
+	bvh->root = top_node(bvh, roots, count);
+	return (TRUE);
+}
+
+static void	refit_node(t_bvh *bvh, const t_object *objects, int index)
+{
+	t_bvh_node	*node;
+	t_bsphere	bs;
+	t_real		r;
+	int			i;
+
+	node = &bvh->nodes[index];
+	if (node->count == 0)
+	{
+		refit_node(bvh, objects, node->left);
+		refit_node(bvh, objects, node->right);
+		node->lo = bvh->nodes[node->left].lo;
+		node->hi = bvh->nodes[node->left].hi;
+		box_grow(&node->lo, &node->hi, bvh->nodes[node->right].lo,
+			bvh->nodes[node->right].hi);
+		return ;
+	}
+	node->lo = vec3_create(INFINITY, INFINITY, INFINITY);
+	node->hi = vec3_create(-INFINITY, -INFINITY, -INFINITY);
+	i = node->first - 1;
+	while (++i < node->first + node->count)
+	{
+		object_bounds(&objects[bvh->items[i]], &bs);
+		r = bs.radius + RT_EPSILON;
+		box_grow(&node->lo, &node->hi, vec3_sub(bs.center,
+				vec3_create(r, r, r)), vec3_add(bs.center,
+				vec3_create(r, r, r)));
+	}
+}
+
+/*
+** Recompute every box bottom-up after objects moved, keeping the tree.
+** Linear in the node count, far cheaper than a rebuild; the tree gets
+** looser the further objects travel from where it was built.
+*/
+void	bvh_refit(t_bvh *bvh, const t_object *objects)
+{
+	if (bvh && bvh->root >= 0)
+		refit_node(bvh, objects, bvh->root);
+}
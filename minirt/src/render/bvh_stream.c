@@ -0,0 +1,140 @@
+#include "../../includes/minirt_app.h"
+#include <unistd.h>
+
+/*
+** Builder thread: pop batches as the parser pushes them and build their
+** treelets, until the queue is closed and drained. Each builder keeps
+** one scratch arena, transparent huge pages requested, for all its
+** batches.
+*/
+static void	*builder(void *arg)
+{
+	t_bvh_stream	*stream;
+	t_bvh_batch		*batch;
+	t_arena			scratch;
+	int				ok;
+
+	stream = arg;
+	arena_init(&scratch, ARENA_SCRATCH_SIZE, TRUE);
+	pthread_mutex_lock(&stream->lock);
+	while (stream->head || !stream->closed)
+	{
+		if (!stream->head)
+		{
+			pthread_cond_wait(&stream->ready, &stream->lock);
+			continue ;
+		}
+		batch = stream->head;
+		stream->head = batch->next;
+		if (!stream->head)
+			stream->tail = NULL;
+		pthread_mutex_unlock(&stream->lock);
+		ok = bvh_build_batch(batch, &scratch);
+		pthread_mutex_lock(&stream->lock);
+		if (!ok)
+			stream->failed = TRUE;
+		batch->next = stream->done;
+		stream->done = batch;
+	}
+	pthread_mutex_unlock(&stream->lock);
+	arena_destroy(&scratch);
+	return (NULL);
+}
+
+t_bvh_stream	*bvh_stream_start(void)
+{
+	t_bvh_stream	*stream;
+	long			n;
+
+	stream = malloc(sizeof(t_bvh_stream));
+	if (!stream)
+		return (NULL);
+	ft_bzero(stream, sizeof(t_bvh_stream));
+	pthread_mutex_init(&stream->lock, NULL);
+	pthread_cond_init(&stream->ready, NULL);
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > MAX_BVH_BUILDERS)
+		n = MAX_BVH_BUILDERS;
+	while (stream->num_threads < n && pthread_create(
+			&stream->threads[stream->num_threads], NULL, builder, stream) == 0)
+		stream->num_threads++;
+	return (stream);
+}
+
+/*
+** Queue a copy of the next count objects of a parse chunk. Objects of a
+** chunk must be pushed in order, by one thread.
+*/
+void	bvh_stream_push(t_bvh_stream *stream, int chunk,
+		const t_object *objects, int count)
+{
+	t_bvh_batch	*batch;
+
+	if (!stream || count <= 0)
+		return ;
+	batch = malloc(sizeof(t_bvh_batch));
+	if (batch)
+	{
+		ft_bzero(batch, sizeof(t_bvh_batch));
+		batch->objects = malloc(sizeof(t_object) * count);
+	}
+	pthread_mutex_lock(&stream->lock);
+	if (!batch || !batch->objects)
+		return (stream->failed = TRUE, pthread_mutex_unlock(&stream->lock),
+			bvh_free_batch(batch));
+	ft_memcpy(batch->objects, objects, sizeof(t_object) * count);
+	batch->count = count;
+	batch->chunk = chunk;
+	batch->first = stream->chunk_count[chunk];
+	stream->chunk_count[chunk] += count;
+	if (stream->tail)
+		stream->tail->next = batch;
+	else
+		stream->head = batch;
+	stream->tail = batch;
+	pthread_cond_signal(&stream->ready);
+	pthread_mutex_unlock(&stream->lock);
+}
+
+/* Index in the merged scene of the first object of a parse chunk */
+void	bvh_stream_place(t_bvh_stream *stream, int chunk, int first)
+{
+	if (stream)
+		stream->chunk_base[chunk] = first;
+}
+
+/*
+** Close the queue, wait for the builders and link their treelets into
+** one hierarchy. NULL if anything failed along the way, in which case
+** the renderer falls back to testing every object.
+*/
+t_bvh	*bvh_stream_finish(t_bvh_stream *stream)
+{
+	t_bvh_batch	*batch;
+	t_bvh		*bvh;
+	int			i;
+
+	if (!stream)
+		return (NULL);
+	pthread_mutex_lock(&stream->lock);
+	stream->closed = TRUE;
+	pthread_cond_broadcast(&stream->ready);
+	pthread_mutex_unlock(&stream->lock);
+	i = -1;
+	while (++i < stream->num_threads)
+		pthread_join(stream->threads[i], NULL);
+	builder(stream);
+	bvh = NULL;
+	if (!stream->failed)
+		bvh = bvh_assemble(stream);
+	while (stream->done)
+	{
+		batch = stream->done;
+		stream->done = batch->next;
+		bvh_free_batch(batch);
+	}
+	pthread_mutex_destroy(&stream->lock);
+	pthread_cond_destroy(&stream->ready);
+	free(stream);
+	return (bvh);
+}
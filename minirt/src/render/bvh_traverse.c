@@ -0,0 +1,81 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Slab test against a node box, clipped to [0, max_t]
+*/
+static int	box_hit(const t_bvh_node *node, const t_ray *ray, t_vec3 inv,
+		t_real max_t)
+{
+	t_real	t0;
+	t_real	t1;
+	t_real	tmin;
+	t_real	tmax;
+
+	t0 = (node->lo.x - ray->origin.x) * inv.x;
+	t1 = (node->hi.x - ray->origin.x) * inv.x;
+	tmin = fmin(t0, t1);
+	tmax = fmax(t0, t1);
+	t0 = (node->lo.y - ray->origin.y) * inv.y;
+	t1 = (node->hi.y - ray->origin.y) * inv.y;
+	tmin = fmax(tmin, fmin(t0, t1));
+	tmax = fmin(tmax, fmax(t0, t1));
+	t0 = (node->lo.z - ray->origin.z) * inv.z;
+	t1 = (node->hi.z - ray->origin.z) * inv.z;
+	tmin = fmax(tmin, fmin(t0, t1));
+	tmax = fmin(tmax, fmax(t0, t1));
+	return (tmax >= fmax(tmin, 0) && tmin <= max_t);
+}
+
+static int	any_hit(const t_compiled *cs, const int *items, int count,
+		const t_ray *ray, t_real max_t)
+{
+	t_real	t;
+	int		part;
+	int		i;
+
+	i = -1;
+	while (++i < count)
+	{
+		t = prim_hit(&cs->prims[items[i]], ray, &part);
+		if (t > 0 && t < max_t)
+			return (TRUE);
+	}
+	return (FALSE);
+}
+
+/*
+** TRUE if anything blocks the ray before max_t. Unbounded objects are
+** tested first, then the hierarchy depth first with an explicit stack.
+*/
+int	bvh_occluded(const t_compiled *cs, const t_ray *ray, t_real max_t)
+{
+	const t_bvh			*bvh;
+	const t_bvh_node	*node;
+	int					stack[BVH_STACK_SIZE];
+	int					sp;
+	t_vec3				inv;
+
+	bvh = cs->bvh;
+	if (any_hit(cs, bvh->unbounded, bvh->num_unbounded, ray, max_t))
+		return (TRUE);
+	if (bvh->root < 0)
+		return (FALSE);
+	inv = vec3_create(1 / ray->direction.x, 1 / ray->direction.y,
+			1 / ray->direction.z);
+	stack[0] = bvh->root;
+	sp = 1;
+	while (sp > 0)
+	{
+		node = &bvh->nodes[stack[--sp]];
+		if (!box_hit(node, ray, inv, max_t))
+			continue ;
+		if (node->count && any_hit(cs, bvh->items + node->first,
+				node->count, ray, max_t))
+			return (TRUE);
+		if (node->count)
+			continue ;
+		stack[sp++] = node->left;
+		stack[sp++] = node->right;
+	}
+	return (FALSE);
+}
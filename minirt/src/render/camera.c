@@ -0,0 +1,56 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Build the camera basis once per frame. The parsed FOV is horizontal,
+** the vertical extent follows from the aspect ratio.
+*/
+void	view_setup(t_view *view, const t_camera *camera, int width, int height)
+{
+	t_vec3	world_up;
+	t_real	fov;
+
+	view->origin = camera->position;
+	view->forward = vec3_normalize(camera->orientation);
+	world_up = vec3_create(0, 1, 0);
+	if (fabs(vec3_dot(view->forward, world_up)) > 0.999)
+		world_up = vec3_create(0, 0, 1);
+	view->right = vec3_normalize(vec3_cross(view->forward, world_up));
+	view->up = vec3_cross(view->right, view->forward);
+	fov = camera->fov;
+	if (fov > MAX_FOV_DEG)
+		fov = MAX_FOV_DEG;
+	view->half_w = tan(fov * M_PI / 360.0);
+	view->half_h = view->half_w * (t_real)height / (t_real)width;
+	view->width = width;
+	view->height = height;
+	view->top = 0;
+	view->image_height = height;
+}
+
+/*
+** Narrow a view to rows [top, top + rows) of its image: rays and
+** projections stay those of the whole image, row 0 of the view being
+** row top of the image
+*/
+void	view_band(t_view *view, int top, int rows)
+{
+	view->top = top;
+	view->height = rows;
+}
+
+/*
+** Primary ray through the image position (px, py), in pixel units
+*/
+t_ray	view_ray(const t_view *view, t_real px, t_real py)
+{
+	t_ray	ray;
+	t_real	x;
+	t_real	y;
+
+	x = (2.0 * px / view->width - 1.0) * view->half_w;
+	y = (1.0 - 2.0 * (py + view->top) / view->image_height) * view->half_h;
+	ray.origin = view->origin;
+	ray.direction = vec3_normalize(vec3_add(view->forward,
+				vec3_add(vec3_mult(view->right, x), vec3_mult(view->up, y))));
+	return (ray);
+}
@@ -0,0 +1,161 @@
+#include "../../includes/minirt_app.h"
+
+/* Kernels of the types without a dedicated loop, indexed by type */
+static const t_kernel	g_kernels[PRIM_TYPES] = {NULL, hit_sphere, hit_plane,
+	hit_cylinder, hit_cone, hit_box, hit_quad, hit_disc};
+
+/*
+** Stable counting sort of span->count object indices by type into out,
+** recording where each type starts in span->runs. items NULL stands for
+** the indices 0 to count - 1.
+*/
+void	span_by_type(t_span *span, const t_object *objects, const int *items,
+		int *out)
+{
+	int	cursor[PRIM_TYPES + 1];
+	int	index;
+	int	i;
+
+	ft_bzero(span->runs, sizeof(span->runs));
+	i = -1;
+	while (++i < span->count)
+	{
+		index = i;
+		if (items)
+			index = items[i];
+		span->runs[objects[index].type + 1]++;
+	}
+	i = 0;
+	while (++i <= PRIM_TYPES)
+		span->runs[i] += span->runs[i - 1];
+	ft_memcpy(cursor, span->runs, sizeof(cursor));
+	i = -1;
+	while (++i < span->count)
+	{
+		index = i;
+		if (items)
+			index = items[i];
+		out[cursor[objects[index].type]++] = index;
+	}
+	span->items = out;
+}
+
+static void	record(t_hit *hit, t_real t, int index, int part)
+{
+	if (t > 0 && t < hit->t)
+	{
+		hit->t = t;
+		hit->index = index;
+		hit->part = part;
+	}
+}
+
+/*
+** Spheres go through the batched solver QUADRATIC_LANES at a time, with
+** the coefficients hit_sphere would use
+*/
+static void	closest_spheres(const t_compiled *cs, t_span run,
+		const t_ray *ray, t_hit *hit)
+{
+	t_quadratics	q;
+	const t_prim	*sp;
+	t_vec3			oc;
+	int				i;
+
+	while (run.count > 0)
+	{
+		q.count = QUADRATIC_LANES;
+		if (run.count < QUADRATIC_LANES)
+			q.count = run.count;
+		i = -1;
+		while (++i < q.count)
+		{
+			sp = &cs->prims[run.items[i]];
+			oc = vec3_sub(ray->origin, sp->origin);
+			q.a[i] = vec3_dot(ray->direction, ray->direction);
+			q.half_b[i] = vec3_dot(oc, ray->direction);
+			q.c[i] = vec3_dot_wide(oc, oc) - sp->k;
+		}
+		solve_quadratic_batch(&q, RT_EPSILON);
+		i = -1;
+		while (++i < q.count)
+			record(hit, q.t[i], run.items[i], PART_SIDE);
+		run.items += q.count;
+		run.count -= q.count;
+	}
+}
+
+/* hit_plane, inlined */
+static void	closest_planes(const t_compiled *cs, t_span run,
+		const t_ray *ray, t_hit *hit)
+{
+	const t_prim	*pl;
+	t_real			denom;
+	t_real			t;
+	int				i;
+
+	i = -1;
+	while (++i < run.count)
+	{
+		pl = &cs->prims[run.items[i]];
+		denom = vec3_dot(pl->axis, ray->direction);
+		if (fabs(denom) < 1e-9)
+			continue ;
+		t = vec3_dot(vec3_sub(pl->origin, ray->origin), pl->axis) / denom;
+		if (t > RT_EPSILON)
+			record(hit, t, run.items[i], PART_SIDE);
+	}
+}
+
+/*
+** Every other type: the kernel is picked once for the run, so the inner
+** loop is one predictable call per object
+*/
+static void	closest_run(const t_compiled *cs, t_span run,
+		const t_ray *ray, t_hit *hit)
+{
+	t_kernel	kernel;
+	t_real		t;
+	int			part;
+	int			i;
+
+	if (run.count == 0)
+		return ;
+	kernel = g_kernels[cs->prims[run.items[0]].type];
+	i = -1;
+	while (++i < run.count)
+	{
+		t = kernel(&cs->prims[run.items[i]], ray, &part);
+		record(hit, t, run.items[i], part);
+	}
+}
+
+/*
+** Closest hit among a type-sorted candidate list, type by type. Only t,
+** the index and the part are recorded, the rest waits for the winner.
+** Scenes made only of spheres and planes stop after their two loops.
+*/
+void	closest_in_span(const t_compiled *cs, t_span span, const t_ray *ray,
+		t_hit *hit)
+{
+	t_span	run;
+	int		type;
+
+	run.items = span.items + span.runs[SPHERE];
+	run.count = span.runs[SPHERE + 1] - span.runs[SPHERE];
+	closest_spheres(cs, run, ray, hit);
+	run.items = span.items + span.runs[PLANE];
+	run.count = span.runs[PLANE + 1] - span.runs[PLANE];
+	closest_planes(cs, run, ray, hit);
+	if (!(cs->types & ~((1 << SPHERE) | (1 << PLANE))))
+		return ;
+	type = PLANE;
+	while (++type < PRIM_TYPES)
+	{
+		if (!(cs->types & (1 << type)))
+			continue ;
+		run.items = span.items + span.runs[type];
+		run.count = span.runs[type + 1] - span.runs[type];
+		closest_run(cs, run, ray, hit);
+	}
+}
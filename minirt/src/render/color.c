@@ -0,0 +1,42 @@
+#include "../../includes/minirt_app.h"
+
+t_color3	clamp_color(t_color3 color)
+{
+	if (color.x > 1.0)
+		color.x = 1.0;
+	if (color.y > 1.0)
+		color.y = 1.0;
+	if (color.z > 1.0)
+		color.z = 1.0;
+	if (color.x < 0.0)
+		color.x = 0.0;
+	if (color.y < 0.0)
+		color.y = 0.0;
+	if (color.z < 0.0)
+		color.z = 0.0;
+	return (color);
+}
+
+int	color_to_int(t_color3 color)
+{
+	color = clamp_color(color);
+	return (((int)(255.999 * color.x) << 16) | ((int)(255.999 * color.y) << 8)
+		| (int)(255.999 * color.z));
+}
+
+/*
+** Vertical white-to-blue gradient shown where no object is hit
+*/
+t_color3	sky_color(const t_ray *ray)
+{
+	t_real	t;
+
+	t = 0.5 * (vec3_normalize(ray->direction).y + 1.0);
+	return (vec3_add(vec3_mult(vec3_create(1.0, 1.0, 1.0), 1.0 - t),
+			vec3_mult(vec3_create(0.5, 0.7, 1.0), t)));
+}
+
+int	get_sky_color(t_ray ray)
+{
+	return (color_to_int(sky_color(&ray)));
+}
@@ -0,0 +1,147 @@
+#include "../../includes/minirt_app.h"
+
+static void	compile_cold(t_prim_cold *cold, const t_object *obj, int index)
+{
+	if (obj->type == SPHERE)
+		cold->material = obj->data.sphere.material;
+	else if (obj->type == PLANE)
+		cold->material = obj->data.plane.material;
+	else if (obj->type == CYLINDER)
+		cold->material = obj->data.cylinder.material;
+	else if (obj->type == CONE)
+		cold->material = obj->data.cone.material;
+	else if (obj->type == BOX)
+		cold->material = obj->data.box.material;
+	else if (obj->type == QUAD)
+		cold->material = obj->data.quad.material;
+	else
+		cold->material = obj->data.disc.material;
+	cold->source = index;
+}
+
+/*
+** Frame of a box or quad, built once here instead of per ray: side made
+** unit and perpendicular to the unit axis, both stored in float
+*/
+static void	compile_frame(t_prim *prim, t_vec3 side, t_vec3 axis)
+{
+	axis = vec3_normalize(axis);
+	side = vec3_normalize(vec3_sub(side, vec3_mult(axis,
+					vec3_dot(side, axis))));
+	prim->frame[0][0] = side.x;
+	prim->frame[0][1] = side.y;
+	prim->frame[0][2] = side.z;
+	prim->frame[1][0] = axis.x;
+	prim->frame[1][1] = axis.y;
+	prim->frame[1][2] = axis.z;
+}
+
+/* Boxes, quads and discs: center, frame or unit normal, sizes */
+static void	compile_flat(t_prim *prim, const t_object *obj)
+{
+	if (obj->type == BOX)
+	{
+		prim->origin = obj->data.box.center;
+		compile_frame(prim, obj->data.box.side, obj->data.box.axis);
+		prim->half[0] = obj->data.box.size.x * 0.5;
+		prim->extent = obj->data.box.size.y * 0.5;
+		prim->half[1] = obj->data.box.size.z * 0.5;
+	}
+	else if (obj->type == QUAD)
+	{
+		prim->origin = obj->data.quad.center;
+		compile_frame(prim, obj->data.quad.side, obj->data.quad.normal);
+		prim->half[0] = obj->data.quad.width * 0.5;
+		prim->half[1] = obj->data.quad.height * 0.5;
+	}
+	else if (obj->type == DISC)
+	{
+		prim->origin = obj->data.disc.center;
+		prim->axis = vec3_normalize(obj->data.disc.normal);
+		prim->k = obj->data.disc.diameter * obj->data.disc.diameter * 0.25;
+	}
+}
+
+/*
+** Hot record with the per-object constants the intersection kernels use
+*/
+static void	compile_prim(t_prim *prim, const t_object *obj)
+{
+	ft_bzero(prim, sizeof(t_prim));
+	prim->type = obj->type;
+	if (obj->type == SPHERE)
+	{
+		prim->origin = obj->data.sphere.center;
+		prim->k = obj->data.sphere.diameter * obj->data.sphere.diameter * 0.25;
+	}
+	else if (obj->type == PLANE)
+	{
+		prim->origin = obj->data.plane.point;
+		prim->axis = vec3_normalize(obj->data.plane.normal);
+	}
+	else if (obj->type == CYLINDER)
+	{
+		prim->origin = obj->data.cylinder.center;
+		prim->axis = vec3_normalize(obj->data.cylinder.axis);
+		prim->k = obj->data.cylinder.diameter
+			* obj->data.cylinder.diameter * 0.25;
+		prim->extent = obj->data.cylinder.height * 0.5;
+	}
+	else if (obj->type == CONE)
+	{
+		prim->origin = obj->data.cone.vertex;
+		prim->axis = vec3_normalize(obj->data.cone.axis);
+		prim->k = cos(obj->data.cone.angle) * cos(obj->data.cone.angle);
+		prim->extent = obj->data.cone.height;
+	}
+	else
+		compile_flat(prim, obj);
+}
+
+int	compile_scene(t_compiled *cs, const t_scene *scene)
+{
+	int	i;
+
+	ft_bzero(cs, sizeof(t_compiled));
+	cs->scene = scene;
+	cs->bvh = scene->bvh;
+	if (posix_memalign((void **)&cs->prims, sizeof(t_prim),
+			(scene->num_objects + 1) * sizeof(t_prim)) != 0)
+		return (cs->prims = NULL, FALSE);
+	cs->cold = malloc((scene->num_objects + 1) * sizeof(t_prim_cold));
+	cs->order = malloc((scene->num_objects + 1) * sizeof(int));
+	if (!cs->cold || !cs->order)
+		return (compiled_free(cs), FALSE);
+	i = -1;
+	while (++i < scene->num_objects)
+	{
+		compile_prim(&cs->prims[i], &scene->objects[i]);
+		compile_cold(&cs->cold[i], &scene->objects[i], i);
+		cs->types |= 1 << scene->objects[i].type;
+	}
+	cs->count = scene->num_objects;
+	cs->all.count = scene->num_objects;
+	span_by_type(&cs->all, scene->objects, NULL, cs->order);
+	return (TRUE);
+}
+
+/*
+** Refresh the records of one object after an edit of cs->scene. The
+** type does not change, so the sorted lists stay valid.
+*/
+void	compile_object(t_compiled *cs, int index)
+{
+	compile_prim(&cs->prims[index], &cs->scene->objects[index]);
+	compile_cold(&cs->cold[index], &cs->scene->objects[index], index);
+}
+
+void	compiled_free(t_compiled *cs)
+{
+	free(cs->prims);
+	free(cs->cold);
+	free(cs->order);
+	cs->prims = NULL;
+	cs->cold = NULL;
+	cs->order = NULL;
+	cs->count = 0;
+}
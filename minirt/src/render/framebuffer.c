@@ -0,0 +1,141 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** One allocation holding the three planes, zeroed so an accumulating
+** frame can start adding right away
+*/
+int	framebuffer_init(t_framebuffer *fb, int width, int height)
+{
+	size_t	n;
+
+	ft_bzero(fb, sizeof(t_framebuffer));
+	n = (size_t)width * height;
+	if (posix_memalign((void **)&fb->plane[0], 64,
+			(n * 3 + 1) * sizeof(float)) != 0)
+		return (fb->plane[0] = NULL, FALSE);
+	ft_bzero(fb->plane[0], n * 3 * sizeof(float));
+	fb->plane[1] = fb->plane[0] + n;
+	fb->plane[2] = fb->plane[1] + n;
+	fb->width = width;
+	fb->height = height;
+	fb->exposure = 1.0f;
+	return (TRUE);
+}
+
+void	framebuffer_free(t_framebuffer *fb)
+{
+	free(fb->plane[0]);
+	ft_bzero(fb, sizeof(t_framebuffer));
+}
+
+/*
+** 8x8 Bayer threshold in [0, 1): the bits of x ^ y and y interleaved and
+** reversed, plain integer arithmetic so the row loop stays vectorized
+*/
+static float	bayer(int x, int y)
+{
+	int	a;
+
+	a = x ^ y;
+	return ((float)(((a & 1) << 5) | ((y & 1) << 4) | ((a & 2) << 2)
+		| ((y & 2) << 1) | ((a & 4) >> 1) | ((y & 4) >> 2)) * (1.0f / 64.0f)
+		+ (0.5f / 64.0f));
+}
+
+/*
+** Linear value to an 8-bit level before truncation. The sRGB curve
+** above its linear toe uses the three-square-root fit of
+** 1.055 c^(1 / 2.4) - 0.055, within 0.4 of a level of the exact curve.
+*/
+static float	encode(float c, int transfer)
+{
+	float	s1;
+	float	s2;
+	float	s3;
+	float	curve;
+
+	c = c * (c > 0.0f);
+	if (transfer == TRANSFER_LINEAR)
+		return (c * 255.999f);
+	s1 = sqrtf(c);
+	s2 = sqrtf(s1);
+	s3 = sqrtf(s2);
+	curve = 0.585122381f * s1 + 0.783140355f * s2 - 0.368262736f * s3;
+	if (c <= 0.0031308f)
+		curve = 12.92f * c;
+	return (curve * 255.0f);
+}
+
+static unsigned int	level(float v)
+{
+	if (v > 255.0f)
+		v = 255.0f;
+	return ((unsigned int)(int)v);
+}
+
+/*
+** Pixels [row[1], row[2]) of row row[0] through the resolve pass: scale
+** by exposure / samples, encode, dither and pack into dst, the start of
+** the image row. shift holds where red, green and blue go in the 32-bit
+** word so the byte order is settled before the loop. The bounds are
+** read once: dst may alias an int, which would stop vectorization.
+*/
+static void	resolve_row(const t_framebuffer *fb, const int row[3],
+		unsigned int *dst, const int shift[3])
+{
+	const float	*p[3];
+	float		scale;
+	float		d;
+	int			end;
+	int			x;
+
+	scale = fb->exposure / fb->samples;
+	p[0] = fb->plane[0] + (size_t)row[0] * fb->width;
+	p[1] = fb->plane[1] + (size_t)row[0] * fb->width;
+	p[2] = fb->plane[2] + (size_t)row[0] * fb->width;
+	x = row[1] - 1;
+	end = row[2];
+	while (++x < end)
+	{
+		d = 0.0f;
+		if (fb->transfer != TRANSFER_LINEAR)
+			d = bayer(x, row[0]);
+		dst[x] = level(encode(p[0][x] * scale, fb->transfer) + d) << shift[0]
+			| level(encode(p[1][x] * scale, fb->transfer) + d) << shift[1]
+			| level(encode(p[2][x] * scale, fb->transfer) + d) << shift[2];
+	}
+}
+
+/*
+** Resolve the rectangle [x0, x1) x [y0, y1) given as rect into the
+** render's 32-bit image. endian is the image's byte order as mlx
+** reports it, 0 for least significant byte first: on a host of the
+** other order the channels move to the opposite bytes.
+*/
+void	framebuffer_resolve(const t_framebuffer *fb, const t_render *r,
+		const int rect[4])
+{
+	int	shift[3];
+	int	row[3];
+
+	shift[0] = 16;
+	shift[1] = 8;
+	shift[2] = 0;
+	if (r->endian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
+	{
+		shift[0] = 8;
+		shift[1] = 16;
+		shift[2] = 24;
+	}
+	if (fb->samples <= 0)
+		return ;
+	row[0] = rect[1];
+	row[1] = rect[0];
+	row[2] = rect[2];
+	while (row[0] < rect[3])
+	{
+		resolve_row(fb, row, (unsigned int *)(r->addr
+				+ (size_t)row[0] * r->line_length), shift);
+		row[0]++;
+	}
+}
@@ -0,0 +1,178 @@
+#include "../../includes/minirt_app.h"
+
+t_real	hit_sphere(const t_prim *sp, const t_ray *ray, int *part)
+{
+	t_vec3	oc;
+
+	*part = PART_SIDE;
+	oc = vec3_sub(ray->origin, sp->origin);
+	return (solve_quadratic(vec3_dot(ray->direction, ray->direction),
+			vec3_dot(oc, ray->direction),
+			vec3_dot_wide(oc, oc) - sp->k, RT_EPSILON));
+}
+
+t_real	hit_plane(const t_prim *pl, const t_ray *ray, int *part)
+{
+	t_real	denom;
+	t_real	t;
+
+	*part = PART_SIDE;
+	denom = vec3_dot(pl->axis, ray->direction);
+	if (fabs(denom) < 1e-9)
+		return (-1.0);
+	t = vec3_dot(vec3_sub(pl->origin, ray->origin), pl->axis) / denom;
+	if (t > RT_EPSILON)
+		return (t);
+	return (-1.0);
+}
+
+/*
+** Keep the nearer of the current best and a cap hit, tagging the part
+*/
+static t_real	closest(t_real best, t_real t, int cap, int *part)
+{
+	if (t > 0 && (best < 0 || t < best))
+	{
+		*part = cap;
+		return (t);
+	}
+	return (best);
+}
+
+/*
+** Ray parameter where the ray crosses the cap plane at axial offset y,
+** given the axial offsets xv of the ray origin and dv of its direction
+*/
+static t_real	cap_t(t_real y, t_real xv, t_real dv)
+{
+	t_real	t;
+
+	if (fabs(dv) < 1e-9)
+		return (-1.0);
+	t = (y - xv) / dv;
+	if (t <= RT_EPSILON)
+		return (-1.0);
+	return (t);
+}
+
+/*
+** Cheap rejection against a bounding sphere before any quadratic: the
+** ray line passes farther than sqrt(r2) from center, or the ray starts
+** outside the sphere and points away from it. Done in double with a
+** little slack so it never rejects a ray the exact test would accept.
+*/
+static int	misses_bounds(const t_ray *ray, t_vec3 center, double r2)
+{
+	t_vec3	oc;
+	double	tca;
+	double	dd;
+	double	oc2;
+
+	oc = vec3_sub(center, ray->origin);
+	tca = vec3_dot_wide(oc, ray->direction);
+	dd = vec3_dot_wide(ray->direction, ray->direction);
+	oc2 = vec3_dot_wide(oc, oc);
+	r2 += RT_EPSILON;
+	return ((tca < 0 && oc2 > r2) || oc2 * dd - tca * tca > r2 * dd);
+}
+
+t_real	hit_cylinder(const t_prim *cy, const t_ray *ray, int *part)
+{
+	t_vec3	x;
+	t_real	dv;
+	t_real	xv;
+	double	roots[2];
+	t_real	best;
+
+	*part = PART_SIDE;
+	if (misses_bounds(ray, cy->origin, cy->k
+			+ (double)cy->extent * cy->extent))
+		return (-1.0);
+	x = vec3_sub(ray->origin, cy->origin);
+	dv = vec3_dot(ray->direction, cy->axis);
+	xv = vec3_dot(x, cy->axis);
+	best = -1.0;
+	if (solve_quadratic_roots(vec3_dot(ray->direction, ray->direction)
+			- dv * dv, vec3_dot(ray->direction, x) - dv * xv,
+			vec3_dot_wide(x, x) - (double)xv * xv - cy->k, roots))
+	{
+		if (roots[1] > RT_EPSILON && fabs(xv + roots[1] * dv) <= cy->extent)
+			best = roots[1];
+		if (roots[0] > RT_EPSILON && fabs(xv + roots[0] * dv) <= cy->extent)
+			best = roots[0];
+	}
+	roots[0] = cap_t(cy->extent, xv, dv);
+	roots[1] = cap_t(-cy->extent, xv, dv);
+	if (roots[0] > 0 && vec3_length_squared(vec3_sub(vec3_add(x, vec3_mult(
+						ray->direction, roots[0])), vec3_mult(cy->axis,
+					cy->extent))) <= cy->k)
+		best = closest(best, roots[0], PART_CAP_TOP, part);
+	if (roots[1] > 0 && vec3_length_squared(vec3_add(vec3_add(x, vec3_mult(
+						ray->direction, roots[1])), vec3_mult(cy->axis,
+					cy->extent))) <= cy->k)
+		best = closest(best, roots[1], PART_CAP_BOTTOM, part);
+	return (best);
+}
+
+/*
+** Finite cone opening from the vertex along the axis, closed by a base
+** disc at distance extent. A point of the base plane lies on the disc
+** when it is inside the cone: y^2 >= cos^2 * |w|^2. The bounding sphere
+** sits halfway up the axis and reaches the base rim, whose squared
+** radius is extent^2 * tan^2 = extent^2 * (1 - cos^2) / cos^2.
+*/
+t_real	hit_cone(const t_prim *cn, const t_ray *ray, int *part)
+{
+	t_vec3	x;
+	t_real	dv;
+	t_real	xv;
+	double	roots[2];
+	t_real	best;
+
+	*part = PART_SIDE;
+	if (cn->k > 0 && misses_bounds(ray, vec3_add(cn->origin,
+				vec3_mult(cn->axis, cn->extent * 0.5)), (double)cn->extent
+			* cn->extent * ((1.0 - cn->k) / cn->k + 0.25)))
+		return (-1.0);
+	x = vec3_sub(ray->origin, cn->origin);
+	dv = vec3_dot(ray->direction, cn->axis);
+	xv = vec3_dot(x, cn->axis);
+	best = -1.0;
+	if (solve_quadratic_roots(dv * dv - cn->k * vec3_dot(ray->direction,
+				ray->direction), dv * xv - cn->k
+			* vec3_dot(ray->direction, x), (double)xv * xv - cn->k
+			* vec3_dot_wide(x, x), roots))
+	{
+		if (roots[1] > RT_EPSILON && xv + roots[1] * dv >= 0
+			&& xv + roots[1] * dv <= cn->extent)
+			best = roots[1];
+		if (roots[0] > RT_EPSILON && xv + roots[0] * dv >= 0
+			&& xv + roots[0] * dv <= cn->extent)
+			best = roots[0];
+	}
+	roots[0] = cap_t(cn->extent, xv, dv);
+	if (roots[0] > 0 && cn->extent * cn->extent >= cn->k
+		* vec3_length_squared(vec3_add(x, vec3_mult(ray->direction,
+					roots[0]))))
+		best = closest(best, roots[0], PART_CAP_TOP, part);
+	return (best);
+}
+
+t_real	prim_hit(const t_prim *prim, const t_ray *ray, int *part)
+{
+	if (prim->type == SPHERE)
+		return (hit_sphere(prim, ray, part));
+	if (prim->type == PLANE)
+		return (hit_plane(prim, ray, part));
+	if (prim->type == CYLINDER)
+		return (hit_cylinder(prim, ray, part));
+	if (prim->type == CONE)
+		return (hit_cone(prim, ray, part));
+	if (prim->type == BOX)
+		return (hit_box(prim, ray, part));
+	if (prim->type == QUAD)
+		return (hit_quad(prim, ray, part));
+	if (prim->type == DISC)
+		return (hit_disc(prim, ray, part));
+	return (-1.0);
+}
@@ -0,0 +1,113 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Clip span to one slab of a box. slab holds the offset from the ray
+** origin to the box center along the slab axis, the inverse of the ray
+** direction along it and the half extent. face remembers which axis
+** last moved each end of the span. fmin/fmax and the arithmetic
+** selects keep it free of branches, and an axis the ray runs parallel
+** to gives infinite bounds that clip nothing or everything.
+*/
+static void	clip_slab(t_real span[2], int face[2], int axis,
+		const t_real slab[3])
+{
+	t_real	near;
+	t_real	far;
+
+	near = fmin((slab[0] - slab[2]) * slab[1], (slab[0] + slab[2]) * slab[1]);
+	far = fmax((slab[0] - slab[2]) * slab[1], (slab[0] + slab[2]) * slab[1]);
+	face[0] += (axis - face[0]) * (near > span[0]);
+	face[1] += (axis - face[1]) * (far < span[1]);
+	span[0] = fmax(span[0], near);
+	span[1] = fmin(span[1], far);
+}
+
+/*
+** Frame of a box or quad: side, axis or normal, then their cross
+** product, the depth of a box and the height of a quad
+*/
+void	prim_frame(const t_prim *prim, t_vec3 frame[3])
+{
+	frame[0] = vec3_create(prim->frame[0][0], prim->frame[0][1],
+			prim->frame[0][2]);
+	frame[1] = vec3_create(prim->frame[1][0], prim->frame[1][1],
+			prim->frame[1][2]);
+	frame[2] = vec3_cross(frame[0], frame[1]);
+}
+
+/*
+** Oriented box as the intersection of three slabs in its frame. A ray
+** entering the box hits at the near end of the span, one starting
+** inside it (a room around the camera) at the far end.
+*/
+t_real	hit_box(const t_prim *bx, const t_ray *ray, int *part)
+{
+	t_vec3	frame[3];
+	t_vec3	to_center;
+	t_real	span[2];
+	int		face[2];
+	t_real	slab[3];
+
+	prim_frame(bx, frame);
+	to_center = vec3_sub(bx->origin, ray->origin);
+	span[0] = -INFINITY;
+	span[1] = INFINITY;
+	face[0] = 0;
+	face[1] = 0;
+	slab[0] = vec3_dot(to_center, frame[0]);
+	slab[1] = 1.0 / vec3_dot(ray->direction, frame[0]);
+	slab[2] = bx->half[0];
+	clip_slab(span, face, 0, slab);
+	slab[0] = vec3_dot(to_center, frame[1]);
+	slab[1] = 1.0 / vec3_dot(ray->direction, frame[1]);
+	slab[2] = bx->extent;
+	clip_slab(span, face, 1, slab);
+	slab[0] = vec3_dot(to_center, frame[2]);
+	slab[1] = 1.0 / vec3_dot(ray->direction, frame[2]);
+	slab[2] = bx->half[1];
+	clip_slab(span, face, 2, slab);
+	if (span[0] > span[1] || span[1] <= RT_EPSILON)
+		return (-1.0);
+	*part = face[span[0] <= RT_EPSILON];
+	if (span[0] > RT_EPSILON)
+		return (span[0]);
+	return (span[1]);
+}
+
+/*
+** hit_plane against the normal in the quad's frame, the hit kept when
+** it falls inside the rectangle's half extents
+*/
+t_real	hit_quad(const t_prim *qd, const t_ray *ray, int *part)
+{
+	t_vec3	frame[3];
+	t_vec3	w;
+	t_real	denom;
+	t_real	t;
+
+	*part = PART_SIDE;
+	prim_frame(qd, frame);
+	denom = vec3_dot(frame[1], ray->direction);
+	if (fabs(denom) < 1e-9)
+		return (-1.0);
+	t = vec3_dot(vec3_sub(qd->origin, ray->origin), frame[1]) / denom;
+	if (t <= RT_EPSILON)
+		return (-1.0);
+	w = vec3_sub(vec3_add(ray->origin, vec3_mult(ray->direction, t)),
+			qd->origin);
+	if (fabs(vec3_dot(w, frame[0])) > qd->half[0]
+		|| fabs(vec3_dot(w, frame[2])) > qd->half[1])
+		return (-1.0);
+	return (t);
+}
+
+t_real	hit_disc(const t_prim *dc, const t_ray *ray, int *part)
+{
+	t_real	t;
+
+	t = hit_plane(dc, ray, part);
+	if (t < 0 || vec3_length_squared(vec3_sub(vec3_add(ray->origin,
+					vec3_mult(ray->direction, t)), dc->origin)) > dc->k)
+		return (-1.0);
+	return (t);
+}
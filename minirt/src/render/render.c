@@ -0,0 +1,378 @@
+#include "../../includes/minirt_app.h"
+#include <pthread.h>
+
+/*
+** The closest hit of a pixel: traced against the tile's candidates and
+** the unbounded objects, or taken from the last committed frame when
+** relighting, shadow test included when the light stayed
+*/
+static void	primary_hit(t_render *r, t_span list, const t_ray *ray,
+		t_gsample *g)
+{
+	size_t	p;
+
+	g->age = 0;
+	g->visible = -1;
+	if (r->relight == RELIGHT_OFF)
+	{
+		g->hit.t = INFINITY;
+		g->hit.index = -1;
+		g->hit.part = PART_SIDE;
+		closest_in_span(&r->compiled, list, ray, &g->hit);
+		closest_in_span(&r->compiled, r->bins.infinite, ray, &g->hit);
+		return ;
+	}
+	p = g - r->gbuffer;
+	g->hit = r->history[p].hit;
+	if (r->relight == RELIGHT_SHADE)
+		g->visible = r->history[p].visible;
+}
+
+/*
+** Color seen through the image position (x, y). Its hit and shadow test
+** are kept in the G-buffer when there is one, and a reprojected frame
+** takes them from the last frame where that frame saw the same surface.
+*/
+static t_color3	sample(t_render *r, t_span list, int x, int y)
+{
+	t_ray		ray;
+	t_gsample	local;
+	t_gsample	*g;
+
+	ray = view_ray(&r->view, x + r->preview * 0.5, y + r->preview * 0.5);
+	g = &local;
+	if (r->gbuffer)
+		g = &r->gbuffer[(size_t)y * r->view.width + x];
+	if (!r->reproject || !reproject_pixel(r, &ray, g - r->gbuffer, g))
+		primary_hit(r, list, &ray, g);
+	if (g->hit.index < 0)
+		return (sky_color(&ray));
+	return (shade_hit(&r->compiled, &ray, &g->hit, &g->visible));
+}
+
+/* Store the first sample of a pixel, add the ones that follow */
+static void	put_sample(t_framebuffer *fb, int x, int y, t_color3 color)
+{
+	size_t	p;
+
+	p = (size_t)y * fb->width + x;
+	if (fb->samples == 1)
+	{
+		fb->plane[0][p] = color.x;
+		fb->plane[1][p] = color.y;
+		fb->plane[2][p] = color.z;
+		return ;
+	}
+	fb->plane[0][p] += color.x;
+	fb->plane[1][p] += color.y;
+	fb->plane[2][p] += color.z;
+}
+
+/*
+** One sample for the preview block anchored at (x, y): the block is
+** filled with it, clipped to the image
+*/
+static void	put_block(t_render *r, int x, int y, t_color3 color)
+{
+	int	bx;
+	int	by;
+
+	by = y - 1;
+	while (++by < y + r->preview && by < r->view.height)
+	{
+		bx = x - 1;
+		while (++bx < x + r->preview && bx < r->view.width)
+			put_sample(&r->fb, bx, by, color);
+	}
+}
+
+/*
+** Primary rays of one tile only test the objects binned into it,
+** plus the unbounded ones. Pixels are visited in the traversal order.
+** A preview frame traces one ray through the center of each block of
+** preview x preview pixels.
+*/
+void	render_tile(t_render *r, int tile)
+{
+	t_span	list;
+	int		x;
+	int		y;
+	int		i;
+
+	list = tile_bins_span(&r->bins, tile);
+	i = -1;
+	while (++i < TILE_SIZE * TILE_SIZE)
+	{
+		x = (tile % r->bins.tiles_x) * TILE_SIZE
+			+ r->pixel_order[i] % TILE_SIZE;
+		y = (tile / r->bins.tiles_x) * TILE_SIZE
+			+ r->pixel_order[i] / TILE_SIZE;
+		if (x >= r->view.width || y >= r->view.height
+			|| x % r->preview || y % r->preview)
+			continue ;
+		put_block(r, x, y, sample(r, list, x, y));
+	}
+}
+
+/*
+** Pull tiles until tile_limit is reached or the frame is cancelled.
+** Background frames publish every finished tile for the event loop.
+** With a tile_done map, tiles marked there are skipped and the others
+** marked once rendered.
+*/
+void	*render_worker(void *arg)
+{
+	t_render	*r;
+	int			tile;
+
+	r = (t_render *)arg;
+	tile = __atomic_fetch_add(&r->next_tile, 1, __ATOMIC_RELAXED);
+	while (tile < r->tile_limit && !__atomic_load_n(&r->async.cancel,
+			__ATOMIC_RELAXED))
+	{
+		tile = r->tile_order[tile];
+		if (!r->tile_done || !r->tile_done[tile])
+			render_tile(r, tile);
+		if (r->tile_done)
+			r->tile_done[tile] = TRUE;
+		if (r->async.ready)
+			render_publish(r, tile);
+		tile = __atomic_fetch_add(&r->next_tile, 1, __ATOMIC_RELAXED);
+	}
+	if (r->async.ready)
+		__atomic_sub_fetch(&r->async.running, 1, __ATOMIC_RELEASE);
+	return (NULL);
+}
+
+static void	*resolve_worker(void *arg)
+{
+	t_render	*r;
+	int			rect[4];
+
+	r = (t_render *)arg;
+	rect[0] = 0;
+	rect[2] = r->view.width;
+	rect[1] = __atomic_fetch_add(&r->next_row, RESOLVE_ROWS,
+			__ATOMIC_RELAXED);
+	while (rect[1] < r->view.height)
+	{
+		rect[3] = rect[1] + RESOLVE_ROWS;
+		if (rect[3] > r->view.height)
+			rect[3] = r->view.height;
+		framebuffer_resolve(&r->fb, r, rect);
+		rect[1] = __atomic_fetch_add(&r->next_row, RESOLVE_ROWS,
+				__ATOMIC_RELAXED);
+	}
+	return (NULL);
+}
+
+/* Resolve the whole framebuffer into the image, in bands of rows */
+void	render_resolve(t_render *r)
+{
+	r->next_row = 0;
+	render_run_workers(r, resolve_worker);
+}
+
+/* Run worker on every render thread, or inline if none would start */
+void	render_run_workers(t_render *r, void *(*worker)(void *))
+{
+	pthread_t	threads[MAX_RENDER_THREADS];
+	int			started;
+
+	started = 0;
+	while (started < r->num_threads && pthread_create(&threads[started],
+			NULL, worker, r) == 0)
+		started++;
+	if (started == 0)
+		worker(r);
+	while (started-- > 0)
+		pthread_join(threads[started], NULL);
+}
+
+/*
+** Frame arena bytes for the view and scene, with room for indices
+** binned object indices: the tile bins and the rectangles they are
+** built from, the tile sequence and the async tile flags, each one
+** aligned. The reprojection splats are only counted when reprojecting.
+*/
+static size_t	frame_size(const t_render *r, size_t indices)
+{
+	size_t	tiles;
+	size_t	objects;
+	size_t	ints;
+	size_t	splats;
+
+	tiles = (size_t)((r->view.width + TILE_SIZE - 1) / TILE_SIZE)
+		* ((r->view.height + TILE_SIZE - 1) / TILE_SIZE);
+	objects = r->scene->num_objects + 1;
+	ints = tiles * PRIM_TYPES + 1 + objects * 4 + indices + 1 + objects * 2
+		+ tiles + tiles + 1;
+	splats = 0;
+	if (r->reproject)
+		splats = (size_t)r->view.width * r->view.height;
+	return (ints * sizeof(int) + splats * sizeof(unsigned long)
+		+ 8 * ARENA_ALIGN);
+}
+
+/*
+** Make sure the frame arena can hold a frame of indices binned object
+** indices, mapping one twice that size when it cannot. Only called with
+** the arena reset, so nothing in it is lost.
+*/
+static int	frame_reserve(t_render *r, size_t indices)
+{
+	size_t	size;
+
+	size = frame_size(r, indices);
+	if (r->frame.base && size <= r->frame.size)
+		return (TRUE);
+	arena_destroy(&r->frame);
+	return (arena_init(&r->frame, size * 2, TRUE));
+}
+
+/*
+** Reserve the frame arena and the framebuffer and pick a thread count,
+** leaving compiled for the caller to fill in. The image is assumed to
+** be in host byte order until the caller says otherwise.
+*/
+int	render_setup(t_render *r, const t_scene *scene, int width, int height)
+{
+	ft_bzero(r, sizeof(t_render));
+	r->scene = scene;
+	r->view.width = width;
+	r->view.height = height;
+	r->image_height = height;
+	r->order = ORDER_HILBERT;
+	r->preview = 1;
+	r->num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (r->num_threads < 1)
+		r->num_threads = 1;
+	if (r->num_threads > MAX_RENDER_THREADS)
+		r->num_threads = MAX_RENDER_THREADS;
+	r->endian = (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+	if (!frame_reserve(r, scene->num_objects))
+		return (FALSE);
+	if (!framebuffer_init(&r->fb, width, height))
+		return (arena_destroy(&r->frame), FALSE);
+	return (TRUE);
+}
+
+/* render_setup with the scene compiled into its render-time layout */
+int	render_init(t_render *r, const t_scene *scene, int width, int height)
+{
+	if (!render_setup(r, scene, width, height))
+		return (FALSE);
+	if (!compile_scene(&r->compiled, scene))
+		return (framebuffer_free(&r->fb), arena_destroy(&r->frame), FALSE);
+	return (TRUE);
+}
+
+/*
+** Per-pixel primary hits and shadow tests. Every frame writes gbuffer,
+** relit and reprojected frames read the last committed one in history.
+** Which of those are still right after an edit is the caller's
+** business.
+*/
+int	render_gbuffer_init(t_render *r)
+{
+	size_t	size;
+
+	size = (size_t)r->view.width * r->view.height * sizeof(t_gsample);
+	r->gbuffer = malloc(size);
+	r->history = malloc(size);
+	if (!r->gbuffer || !r->history)
+	{
+		free(r->gbuffer);
+		free(r->history);
+		r->gbuffer = NULL;
+		r->history = NULL;
+		return (FALSE);
+	}
+	return (TRUE);
+}
+
+/*
+** Keep the frame just finished as the history of the next ones. Only a
+** complete full-resolution frame may be committed: a cancelled one
+** leaves the history as it was.
+*/
+void	render_commit(t_render *r)
+{
+	t_gsample	*swap;
+
+	swap = r->history;
+	r->history = r->gbuffer;
+	r->gbuffer = swap;
+	r->history_view = r->view;
+	r->has_history = TRUE;
+}
+
+void	render_destroy(t_render *r)
+{
+	free(r->gbuffer);
+	free(r->history);
+	compiled_free(&r->compiled);
+	framebuffer_free(&r->fb);
+	arena_destroy(&r->frame);
+}
+
+/*
+** Bin the view in the frame arena, mapped again larger when the view
+** covers more tiles than it was sized for
+*/
+static int	frame_bins(t_render *r)
+{
+	arena_reset(&r->frame, 0);
+	if (!frame_reserve(r, 0))
+		return (FALSE);
+	if (tile_bins_build(&r->bins, r->scene, &r->view, &r->frame))
+		return (TRUE);
+	arena_reset(&r->frame, 0);
+	return (frame_reserve(r, r->bins.total)
+		&& tile_bins_build(&r->bins, r->scene, &r->view, &r->frame));
+}
+
+/*
+** Bin the scene for the current view and reset the tile counter. A
+** framebuffer shorter than image_height holds the band of rows from
+** band_top down.
+** Per-frame tables come from the frame arena, reset here, and stay
+** valid until the next frame, so does the reprojection of the history
+** when reproject is set. Unless accumulate is set every frame starts a
+** fresh framebuffer.
+*/
+int	render_frame_begin(t_render *r)
+{
+	int	rows;
+
+	view_setup(&r->view, &r->scene->camera, r->view.width, r->image_height);
+	rows = r->image_height - r->band_top;
+	if (rows > r->fb.height)
+		rows = r->fb.height;
+	view_band(&r->view, r->band_top, rows);
+	if (!frame_bins(r) || !traversal_build(r))
+		return (printf(ERR_MEMORY), FALSE);
+	if (r->reproject && !(r->has_history && reproject_begin(r)))
+		r->reproject = FALSE;
+	r->frames++;
+	if (!r->accumulate)
+		r->fb.samples = 0;
+	r->fb.samples++;
+	r->next_tile = 0;
+	r->tile_limit = r->bins.tiles_x * r->bins.tiles_y;
+	return (TRUE);
+}
+
+/*
+** Let the worker threads pull tiles from a shared counter, in traversal
+** order, until the frame is done, then resolve the framebuffer into the
+** image in bands of rows
+*/
+int	render_scene(t_render *r)
+{
+	if (!render_frame_begin(r))
+		return (FALSE);
+	render_run_workers(r, render_worker);
+	render_resolve(r);
+	return (TRUE);
+}
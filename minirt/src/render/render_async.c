@@ -0,0 +1,142 @@
+#include "../../includes/minirt_app.h"
+
+/* Pixel rectangle {x0, y0, x1, y1} of a tile, clipped to the view */
+static void	tile_rect(const t_render *r, int tile, int rect[4])
+{
+	rect[0] = (tile % r->bins.tiles_x) * TILE_SIZE;
+	rect[1] = (tile / r->bins.tiles_x) * TILE_SIZE;
+	rect[2] = rect[0] + TILE_SIZE;
+	rect[3] = rect[1] + TILE_SIZE;
+	if (rect[2] > r->view.width)
+		rect[2] = r->view.width;
+	if (rect[3] > r->view.height)
+		rect[3] = r->view.height;
+}
+
+/*
+** Start a frame on the render threads and return at once. If no thread
+** can be started the frame is rendered here instead, it still reaches
+** the window through the queue.
+*/
+int	render_async_start(t_render *r)
+{
+	t_async	*a;
+
+	a = &r->async;
+	if (!render_frame_begin(r))
+		return (FALSE);
+	a->total = r->bins.tiles_x * r->bins.tiles_y;
+	a->ready = arena_alloc(&r->frame, (a->total + 1) * sizeof(int));
+	if (!a->ready)
+		return (printf(ERR_MEMORY), FALSE);
+	ft_bzero(a->ready, (a->total + 1) * sizeof(int));
+	a->tail = 0;
+	a->head = 0;
+	a->cancel = FALSE;
+	a->restart = FALSE;
+	a->finished = FALSE;
+	a->running = r->num_threads;
+	a->started = 0;
+	while (a->started < r->num_threads && pthread_create(
+			&a->threads[a->started], NULL, render_worker, r) == 0)
+		a->started++;
+	__atomic_sub_fetch(&a->running, r->num_threads - a->started,
+		__ATOMIC_RELEASE);
+	if (a->started == 0)
+	{
+		a->running = 1;
+		render_worker(r);
+	}
+	return (TRUE);
+}
+
+/* Worker side: resolve the finished tile, then make it visible */
+void	render_publish(t_render *r, int tile)
+{
+	int	rect[4];
+	int	slot;
+
+	tile_rect(r, tile, rect);
+	framebuffer_resolve(&r->fb, r, rect);
+	slot = __atomic_fetch_add(&r->async.tail, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->async.ready[slot], tile + 1, __ATOMIC_RELEASE);
+}
+
+static void	join_workers(t_async *a)
+{
+	while (a->started > 0)
+		pthread_join(a->threads[--a->started], NULL);
+}
+
+/*
+** Event loop side: copy every tile published since the last call from
+** the back buffer into the front image. Returns the number of tiles
+** copied.
+*/
+int	render_async_present(t_render *r)
+{
+	t_async	*a;
+	int		rect[4];
+	int		copied;
+
+	a = &r->async;
+	copied = 0;
+	while (a->ready && a->head < a->total
+		&& __atomic_load_n(&a->ready[a->head], __ATOMIC_ACQUIRE))
+	{
+		tile_rect(r, a->ready[a->head++] - 1, rect);
+		while (rect[1] < rect[3])
+		{
+			ft_memcpy(a->front + (size_t)rect[1] * r->line_length
+				+ rect[0] * 4, r->addr + (size_t)rect[1] * r->line_length
+				+ rect[0] * 4, (rect[2] - rect[0]) * 4);
+			rect[1]++;
+		}
+		copied++;
+	}
+	return (copied);
+}
+
+/*
+** TRUE once every worker has left the frame, which is then safe to edit
+** or restart. The workers are joined here; they are past their last
+** access by then, so this never waits on the renderer.
+*/
+int	render_async_idle(t_render *r)
+{
+	if (__atomic_load_n(&r->async.running, __ATOMIC_ACQUIRE) != 0)
+		return (FALSE);
+	join_workers(&r->async);
+	return (TRUE);
+}
+
+/*
+** TRUE on the first call after every tile of an uncancelled frame was
+** presented, FALSE before and after
+*/
+int	render_async_finished(t_render *r)
+{
+	if (r->async.finished || r->async.restart
+		|| r->async.head != r->async.total)
+		return (FALSE);
+	r->async.finished = TRUE;
+	return (TRUE);
+}
+
+/*
+** Cancel the current frame from any hook. restart tells the event loop
+** to start the next one once render_async_idle holds.
+*/
+void	render_async_restart(t_render *r)
+{
+	__atomic_store_n(&r->async.cancel, TRUE, __ATOMIC_RELAXED);
+	r->async.restart = TRUE;
+}
+
+/* Cancel the current frame and wait for the workers, before teardown */
+void	render_async_stop(t_render *r)
+{
+	__atomic_store_n(&r->async.cancel, TRUE, __ATOMIC_RELAXED);
+	r->async.restart = FALSE;
+	join_workers(&r->async);
+}
@@ -0,0 +1,208 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** A splat packs the depth of a history hit above the index of its pixel:
+** depths are positive floats, whose bits sort like the values, so the
+** nearest hit is the smallest word. Sky has an infinite depth.
+*/
+static void	claim(unsigned long *slot, float depth, unsigned int index)
+{
+	unsigned int	bits;
+	unsigned long	word;
+	unsigned long	old;
+
+	ft_memcpy(&bits, &depth, sizeof(bits));
+	word = (unsigned long)bits << 32 | index;
+	old = __atomic_load_n(slot, __ATOMIC_RELAXED);
+	while (word < old && !__atomic_compare_exchange_n(slot, &old, word,
+			TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+static float	splat_depth(unsigned long word)
+{
+	unsigned int	bits;
+	float			depth;
+
+	bits = word >> 32;
+	ft_memcpy(&depth, &bits, sizeof(depth));
+	return (depth);
+}
+
+/*
+** Splat one history pixel into the new view: its hit point, seen from
+** the new camera, claims the pixel it falls in unless something nearer
+** did. Sky is seen by direction alone, from wherever the camera is.
+*/
+static void	scatter(t_render *r, int x, int y)
+{
+	const t_gsample	*g;
+	t_ray			ray;
+	t_vec3			rel;
+	t_real			z;
+	size_t			p;
+
+	p = (size_t)y * r->view.width + x;
+	g = &r->history[p];
+	ray = view_ray(&r->history_view, x + 0.5, y + 0.5);
+	rel = ray.direction;
+	if (g->hit.index >= 0)
+		rel = vec3_sub(vec3_add(ray.origin, vec3_mult(ray.direction,
+						g->hit.t)), r->view.origin);
+	z = vec3_dot(rel, r->view.forward);
+	if (z <= RT_EPSILON)
+		return ;
+	x = (int)floor((vec3_dot(rel, r->view.right) / (z * r->view.half_w)
+				+ 1.0) * 0.5 * r->view.width);
+	y = (int)floor((1.0 - vec3_dot(rel, r->view.up) / (z * r->view.half_h))
+			* 0.5 * r->view.height);
+	if (x < 0 || y < 0 || x >= r->view.width || y >= r->view.height)
+		return ;
+	if (g->hit.index < 0)
+		z = INFINITY;
+	claim(&r->splat[(size_t)y * r->view.width + x], z, p);
+}
+
+static void	*scatter_worker(void *arg)
+{
+	t_render	*r;
+	int			y;
+	int			end;
+	int			x;
+
+	r = (t_render *)arg;
+	y = __atomic_fetch_add(&r->next_row, RESOLVE_ROWS, __ATOMIC_RELAXED);
+	while (y < r->view.height)
+	{
+		end = y + RESOLVE_ROWS;
+		if (end > r->view.height)
+			end = r->view.height;
+		while (y < end)
+		{
+			x = -1;
+			while (++x < r->view.width)
+				scatter(r, x, y);
+			y++;
+		}
+		y = __atomic_fetch_add(&r->next_row, RESOLVE_ROWS, __ATOMIC_RELAXED);
+	}
+	return (NULL);
+}
+
+/*
+** Map the history frame, seen through history_view, onto the current
+** view: splat holds for each pixel the nearest history hit landing in
+** it, or SPLAT_NONE. The history is split in bands of rows between the
+** render threads before the frame starts.
+*/
+int	reproject_begin(t_render *r)
+{
+	size_t	n;
+	size_t	i;
+
+	n = (size_t)r->view.width * r->view.height;
+	r->splat = arena_alloc(&r->frame, n * sizeof(unsigned long));
+	if (!r->splat)
+		return (FALSE);
+	i = 0;
+	while (i < n)
+		r->splat[i++] = SPLAT_NONE;
+	r->next_row = 0;
+	render_run_workers(r, scatter_worker);
+	return (TRUE);
+}
+
+/*
+** History pixel splatted onto pixel p, or failing that onto its left,
+** right, upper or lower neighbor: two splats landing on one pixel leave
+** a hole next to it, which the neighbor's surface most likely covers
+** too. depth gets the splat's depth. -1 when there is none.
+*/
+static int	source(const t_render *r, size_t p, float *depth)
+{
+	size_t	q;
+
+	q = p;
+	if (r->splat[q] == SPLAT_NONE && p % r->view.width > 0)
+		q = p - 1;
+	if (r->splat[q] == SPLAT_NONE && (p + 1) % r->view.width > 0)
+		q = p + 1;
+	if (r->splat[q] == SPLAT_NONE && p >= (size_t)r->view.width)
+		q = p - r->view.width;
+	if (r->splat[q] == SPLAT_NONE && p + r->view.width
+		< (size_t)r->view.width * r->view.height)
+		q = p + r->view.width;
+	if (r->splat[q] == SPLAT_NONE)
+		return (-1);
+	*depth = splat_depth(r->splat[q]);
+	return ((int)(r->splat[q] & 0xFFFFFFFFUL));
+}
+
+/*
+** Check the splats around pixel p: a nearer surface next to it is an
+** edge the splat may have got wrong, and neighbors whose shadow tests
+** disagree with out's mark a shadow edge. FALSE on the first, the second
+** only drops the reused shadow test.
+*/
+static int	neighbors(const t_render *r, size_t p, float depth,
+		t_gsample *out)
+{
+	static const int	step[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+	const t_gsample		*n;
+	size_t				q;
+	int					x;
+	int					i;
+
+	i = -1;
+	while (++i < 4)
+	{
+		x = p % r->view.width + step[i][0];
+		q = p + step[i][0] + step[i][1] * r->view.width;
+		if (x < 0 || x >= r->view.width || q >= (size_t)r->view.width
+			* r->view.height || r->splat[q] == SPLAT_NONE)
+			continue ;
+		if (splat_depth(r->splat[q]) < depth * (1.0f - REPROJECT_EDGE))
+			return (FALSE);
+		n = &r->history[r->splat[q] & 0xFFFFFFFFUL];
+		if (n->hit.index >= 0 && n->visible != out->visible)
+			out->visible = -1;
+	}
+	return (TRUE);
+}
+
+/*
+** Reuse the hit and shadow test of the history pixel landing on pixel
+** p when the ray still meets the same object at the reprojected depth:
+** that ID and depth check is one intersection instead of a trace and a
+** shadow ray. Sky is taken as the splat found it, though not to fill
+** a hole. Holes, edges, pixels due for a refresh and failed checks
+** return FALSE to be traced.
+*/
+int	reproject_pixel(t_render *r, const t_ray *ray, size_t p, t_gsample *out)
+{
+	const t_gsample	*g;
+	t_real			t;
+	float			depth;
+	int				from;
+	int				part;
+
+	from = source(r, p, &depth);
+	if (from < 0 || r->history[from].age + 1 >= HISTORY_AGE
+		|| (p % r->view.width + 3 * (p / r->view.width) + r->frames)
+		% HISTORY_AGE == 0)
+		return (FALSE);
+	g = &r->history[from];
+	*out = *g;
+	out->age = g->age + 1;
+	if (!neighbors(r, p, depth, out))
+		return (FALSE);
+	if (g->hit.index < 0)
+		return (r->splat[p] != SPLAT_NONE);
+	t = prim_hit(&r->compiled.prims[g->hit.index], ray, &part);
+	if (t <= 0 || fabs(t * vec3_dot(ray->direction, r->view.forward)
+			- depth) > REPROJECT_DEPTH * depth)
+		return (FALSE);
+	out->hit.t = t;
+	out->hit.part = part;
+	return (TRUE);
+}
@@ -0,0 +1,77 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Any-hit test between point and the light, through the scene BVH when
+** there is one and otherwise brute force over every object, with the
+** per-type loops of closest_in_span
+*/
+int	is_in_shadow(const t_compiled *cs, const t_vec3 point,
+		const t_vec3 light_pos)
+{
+	t_ray	ray;
+	t_real	dist;
+	t_hit	hit;
+
+	ray.origin = point;
+	ray.direction = vec3_sub(light_pos, point);
+	dist = vec3_length(ray.direction);
+	ray.direction = vec3_div(ray.direction, dist);
+	if (cs->bvh)
+		return (bvh_occluded(cs, &ray, dist - RT_EPSILON));
+	hit.t = dist - RT_EPSILON;
+	hit.index = -1;
+	closest_in_span(cs, cs->all, &ray, &hit);
+	return (hit.index >= 0);
+}
+
+t_color3	calculate_ambient(const t_scene *scene, const t_surface *s)
+{
+	(void)s;
+	return (vec3_mult(scene->ambient.color, scene->ambient.ratio));
+}
+
+/*
+** Direct light reaching the surface, none when it faces away or is in
+** shadow. visible caches the shadow test: -1 runs it and keeps the
+** answer there, 0 or 1 is taken as is.
+*/
+t_color3	calculate_diffuse(const t_compiled *cs, const t_surface *s,
+		int *visible)
+{
+	t_vec3	l;
+	t_real	ndl;
+
+	l = vec3_normalize(vec3_sub(cs->scene->light.position, s->point));
+	ndl = vec3_dot(s->normal, l);
+	if (ndl <= 0)
+		return (vec3_create(0, 0, 0));
+	if (*visible < 0)
+		*visible = !is_in_shadow(cs, vec3_add(s->point,
+					vec3_mult(s->normal, RT_EPSILON)),
+				cs->scene->light.position);
+	if (!*visible)
+		return (vec3_create(0, 0, 0));
+	return (vec3_mult(cs->scene->light.color,
+			cs->scene->light.brightness * ndl));
+}
+
+/* Left unclamped, the framebuffer keeps the full range until resolve */
+t_color3	calculate_lighting(const t_compiled *cs, const t_surface *s,
+		int *visible)
+{
+	t_color3	light;
+
+	light = vec3_add(calculate_ambient(cs->scene, s),
+			calculate_diffuse(cs, s, visible));
+	return (vec3_create(s->albedo.x * light.x, s->albedo.y * light.y,
+			s->albedo.z * light.z));
+}
+
+t_color3	shade_hit(const t_compiled *cs, const t_ray *ray, const t_hit *hit,
+		int *visible)
+{
+	t_surface	surface;
+
+	surface_from_hit(cs, ray, hit, &surface);
+	return (calculate_lighting(cs, &surface, visible));
+}
@@ -0,0 +1,111 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Outward normal at a point of the primitive, the cap/side
+** classification coming from the intersection kernel. Flat primitives
+** and box faces are returned unoriented, surface_from_hit flips them
+** towards the ray anyway.
+*/
+t_vec3	prim_normal(const t_prim *prim, t_point3 p, int part)
+{
+	t_vec3	w;
+	t_vec3	frame[3];
+
+	if (prim->type == BOX || prim->type == QUAD)
+	{
+		prim_frame(prim, frame);
+		if (prim->type == QUAD)
+			return (frame[1]);
+		return (frame[part]);
+	}
+	if (prim->type == PLANE || prim->type == DISC || part == PART_CAP_TOP)
+		return (prim->axis);
+	if (part == PART_CAP_BOTTOM)
+		return (vec3_mult(prim->axis, -1));
+	w = vec3_sub(p, prim->origin);
+	if (prim->type == SPHERE)
+		return (vec3_normalize(w));
+	if (prim->type == CYLINDER)
+		return (vec3_normalize(vec3_sub(w, vec3_mult(prim->axis,
+						vec3_dot(w, prim->axis)))));
+	return (vec3_normalize(vec3_sub(vec3_mult(w, prim->k),
+				vec3_mult(prim->axis, vec3_dot(w, prim->axis)))));
+}
+
+/*
+** Frame coordinates of a box or quad: the two spanning the box face
+** that was hit, width and height on a quad
+*/
+static void	flat_uv(const t_prim *prim, t_vec3 w, t_surface *s, int face)
+{
+	t_vec3	frame[3];
+	t_real	local[3];
+
+	prim_frame(prim, frame);
+	local[0] = vec3_dot(w, frame[0]);
+	local[1] = vec3_dot(w, frame[1]);
+	local[2] = vec3_dot(w, frame[2]);
+	s->u = local[(face + 1) % 3];
+	s->v = local[(face + 2) % 3];
+	if (prim->type == QUAD)
+	{
+		s->u = local[0];
+		s->v = local[2];
+	}
+}
+
+/*
+** Surface coordinates: longitude/latitude on spheres, the plane frame
+** on planes, discs and caps, the compiled frame on quads and box faces,
+** angle around the axis and height on the sides
+*/
+static void	prim_uv(const t_prim *prim, t_surface *s, int part)
+{
+	t_vec3	w;
+	t_vec3	e1;
+	t_vec3	e2;
+
+	w = vec3_sub(s->point, prim->origin);
+	if (prim->type == BOX || prim->type == QUAD)
+	{
+		flat_uv(prim, w, s, part);
+		return ;
+	}
+	if (prim->type == SPHERE)
+	{
+		w = vec3_normalize(w);
+		s->u = 0.5 + atan2(w.z, w.x) / (2.0 * M_PI);
+		s->v = 0.5 - asin(w.y) / M_PI;
+		return ;
+	}
+	vec3_frame(prim->axis, &e1, &e2);
+	if (prim->type == PLANE)
+		w = s->point;
+	s->u = vec3_dot(w, e1);
+	s->v = vec3_dot(w, e2);
+	if (prim->type == PLANE || prim->type == DISC || part != PART_SIDE)
+		return ;
+	s->u = 0.5 + atan2(s->v, s->u) / (2.0 * M_PI);
+	s->v = vec3_dot(w, prim->axis);
+}
+
+/*
+** Single post-traversal pass: position, normal facing the ray, UV and
+** material of the closest hit. Planes get a unit checkerboard in UV.
+*/
+void	surface_from_hit(const t_compiled *cs, const t_ray *ray,
+		const t_hit *hit, t_surface *s)
+{
+	const t_prim	*prim;
+
+	prim = &cs->prims[hit->index];
+	s->point = vec3_add(ray->origin, vec3_mult(ray->direction, hit->t));
+	s->normal = prim_normal(prim, s->point, hit->part);
+	if (vec3_dot(s->normal, ray->direction) > 0)
+		s->normal = vec3_mult(s->normal, -1);
+	prim_uv(prim, s, hit->part);
+	s->material = cs->cold[hit->index].material;
+	s->albedo = s->material.color;
+	if (prim->type == PLANE && (((int)floor(s->u) + (int)floor(s->v)) & 1))
+		s->albedo = vec3_mult(s->albedo, 0.375);
+}
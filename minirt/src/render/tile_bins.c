@@ -0,0 +1,263 @@
+#include "../../includes/minirt_app.h"
+
+/* Boxes, quads and discs are bounded by their half diagonal */
+static int	flat_bounds(const t_object *obj, t_bsphere *b)
+{
+	if (obj->type == BOX)
+	{
+		b->center = obj->data.box.center;
+		b->radius = vec3_length(obj->data.box.size) * 0.5;
+	}
+	else if (obj->type == QUAD)
+	{
+		b->center = obj->data.quad.center;
+		b->radius = sqrt(obj->data.quad.width * obj->data.quad.width
+				+ obj->data.quad.height * obj->data.quad.height) * 0.5;
+	}
+	else if (obj->type == DISC)
+	{
+		b->center = obj->data.disc.center;
+		b->radius = obj->data.disc.diameter * 0.5;
+	}
+	else
+		return (FALSE);
+	return (TRUE);
+}
+
+/*
+** Bounding sphere of a finite object. Returns FALSE for unbounded
+** objects, which must be tested by every ray.
+*/
+int	object_bounds(const t_object *obj, t_bsphere *b)
+{
+	t_real	base;
+
+	if (obj->type >= BOX)
+		return (flat_bounds(obj, b));
+	if (obj->type == SPHERE)
+	{
+		b->center = obj->data.sphere.center;
+		b->radius = obj->data.sphere.diameter * 0.5;
+		return (TRUE);
+	}
+	if (obj->type == CYLINDER)
+	{
+		b->center = obj->data.cylinder.center;
+		b->radius = sqrt(obj->data.cylinder.diameter
+				* obj->data.cylinder.diameter * 0.25
+				+ obj->data.cylinder.height * obj->data.cylinder.height * 0.25);
+		return (TRUE);
+	}
+	if (obj->type != CONE || obj->data.cone.angle >= M_PI * 0.49)
+		return (FALSE);
+	base = obj->data.cone.height * tan(obj->data.cone.angle);
+	b->center = vec3_add(obj->data.cone.vertex,
+			vec3_mult(obj->data.cone.axis, obj->data.cone.height * 0.5));
+	b->radius = sqrt(base * base
+			+ obj->data.cone.height * obj->data.cone.height * 0.25);
+	return (TRUE);
+}
+
+/*
+** Conservative screen extent of x / z over the box [x +- r] x [z +- r],
+** which contains the sphere. x / z is monotonic in z for a fixed x, so
+** the extremes sit on the corners.
+*/
+static void	project_extent(t_real x, t_real z, t_real r, t_real out[2])
+{
+	if (x - r >= 0)
+		out[0] = (x - r) / (z + r);
+	else
+		out[0] = (x - r) / (z - r);
+	if (x + r >= 0)
+		out[1] = (x + r) / (z - r);
+	else
+		out[1] = (x + r) / (z + r);
+}
+
+static int	clamp_tile(t_real v, int size)
+{
+	if (v < 0)
+		v = 0;
+	if (v > size - 1)
+		v = size - 1;
+	return ((int)v / TILE_SIZE);
+}
+
+/*
+** Tile rectangle {x0, y0, x1, y1} covered by the bounding sphere, or
+** FALSE when it lies behind the camera or off screen. Spheres reaching
+** behind the eye plane cover the whole screen.
+*/
+static int	project_bounds(const t_view *v, t_bsphere b, int rect[4])
+{
+	t_vec3	rel;
+	t_real	ex[2];
+	t_real	ey[2];
+	t_real	z;
+
+	rel = vec3_sub(b.center, v->origin);
+	z = vec3_dot(rel, v->forward);
+	if (z + b.radius <= 0)
+		return (FALSE);
+	ex[0] = 0;
+	ex[1] = v->width;
+	ey[0] = 0;
+	ey[1] = v->height;
+	if (z - b.radius > 1e-6)
+	{
+		project_extent(vec3_dot(rel, v->right), z, b.radius, ex);
+		project_extent(vec3_dot(rel, v->up), z, b.radius, ey);
+		z = ey[0];
+		ex[0] = (ex[0] / v->half_w + 1.0) * 0.5 * v->width - 1;
+		ex[1] = (ex[1] / v->half_w + 1.0) * 0.5 * v->width + 1;
+		ey[0] = (1.0 - ey[1] / v->half_h) * 0.5 * v->image_height
+			- v->top - 1;
+		ey[1] = (1.0 - z / v->half_h) * 0.5 * v->image_height
+			- v->top + 1;
+	}
+	if (ex[1] < 0 || ey[1] < 0 || ex[0] >= v->width || ey[0] >= v->height)
+		return (FALSE);
+	rect[0] = clamp_tile(ex[0], v->width);
+	rect[1] = clamp_tile(ey[0], v->height);
+	rect[2] = clamp_tile(ex[1], v->width);
+	rect[3] = clamp_tile(ey[1], v->height);
+	return (TRUE);
+}
+
+/*
+** First pass: project every finite object, count how many land in each
+** (tile, type) slot and remember the rectangles for the fill pass. rects
+** holds four ints per object, x0 == -1 marking objects that reach no
+** tile and x0 == -2 unbounded ones.
+*/
+static int	count_pass(t_tile_bins *bins, const t_scene *scene,
+			const t_view *view, int *rects)
+{
+	t_bsphere	b;
+	int			i;
+	int			x;
+	int			y;
+
+	i = -1;
+	while (++i < scene->num_objects)
+	{
+		rects[i * 4] = -2;
+		if (!object_bounds(&scene->objects[i], &b))
+			bins->infinite.count++;
+		else if (project_bounds(view, b, &rects[i * 4]))
+		{
+			y = rects[i * 4 + 1] - 1;
+			while (++y <= rects[i * 4 + 3])
+			{
+				x = rects[i * 4] - 1;
+				while (++x <= rects[i * 4 + 2])
+					bins->offsets[(y * bins->tiles_x + x) * PRIM_TYPES
+						+ scene->objects[i].type + 1]++;
+			}
+		}
+		else
+			rects[i * 4] = -1;
+	}
+	i = -1;
+	while (++i < bins->tiles_x * bins->tiles_y * PRIM_TYPES)
+		bins->offsets[i + 1] += bins->offsets[i];
+	return (bins->offsets[bins->tiles_x * bins->tiles_y * PRIM_TYPES]);
+}
+
+/*
+** Second pass: scatter object indices into their slots. Objects are
+** visited in scene order so every slot stays sorted by index.
+*/
+static void	fill_pass(t_tile_bins *bins, const t_scene *scene,
+			const int *rects, int *cursor)
+{
+	int	i;
+	int	x;
+	int	y;
+
+	i = -1;
+	while (++i < scene->num_objects)
+	{
+		if (rects[i * 4] < 0)
+			continue ;
+		y = rects[i * 4 + 1] - 1;
+		while (++y <= rects[i * 4 + 3])
+		{
+			x = rects[i * 4] - 1;
+			while (++x <= rects[i * 4 + 2])
+				bins->indices[cursor[(y * bins->tiles_x + x) * PRIM_TYPES
+					+ scene->objects[i].type]++] = i;
+		}
+	}
+}
+
+/* Unbounded objects, in scene order, then sorted by type */
+static int	infinite_list(t_tile_bins *bins, const t_scene *scene,
+			const int *rects, t_arena *frame)
+{
+	int	*list;
+	int	*sorted;
+	int	i;
+	int	n;
+
+	list = arena_alloc(frame, (bins->infinite.count + 1) * sizeof(int));
+	sorted = arena_alloc(frame, (bins->infinite.count + 1) * sizeof(int));
+	if (!list || !sorted)
+		return (FALSE);
+	n = 0;
+	i = -1;
+	while (++i < scene->num_objects)
+		if (rects[i * 4] == -2)
+			list[n++] = i;
+	span_by_type(&bins->infinite, scene->objects, list, sorted);
+	return (TRUE);
+}
+
+/*
+** All lists, and the per-object rectangles used while building them,
+** live in the frame arena and go away with its next reset. FALSE when
+** the arena is too small, total then tells how many indices it needs.
+*/
+int	tile_bins_build(t_tile_bins *bins, const t_scene *scene,
+		const t_view *view, t_arena *frame)
+{
+	int	*rects;
+	int	total;
+	int	slots;
+
+	ft_bzero(bins, sizeof(t_tile_bins));
+	bins->tiles_x = (view->width + TILE_SIZE - 1) / TILE_SIZE;
+	bins->tiles_y = (view->height + TILE_SIZE - 1) / TILE_SIZE;
+	slots = bins->tiles_x * bins->tiles_y * PRIM_TYPES;
+	bins->offsets = arena_alloc(frame, (slots + 1) * sizeof(int));
+	rects = arena_alloc(frame, (scene->num_objects + 1) * 4 * sizeof(int));
+	if (!bins->offsets || !rects)
+		return (FALSE);
+	ft_bzero(bins->offsets, (slots + 1) * sizeof(int));
+	total = count_pass(bins, scene, view, rects);
+	bins->total = total;
+	bins->indices = arena_alloc(frame, (total + 1) * sizeof(int));
+	if (!bins->indices || !infinite_list(bins, scene, rects, frame))
+		return (FALSE);
+	fill_pass(bins, scene, rects, bins->offsets);
+	while (--slots > 0)
+		bins->offsets[slots] = bins->offsets[slots - 1];
+	bins->offsets[0] = 0;
+	return (TRUE);
+}
+
+t_span	tile_bins_span(const t_tile_bins *bins, int tile)
+{
+	t_span		span;
+	const int	*slot;
+	int			k;
+
+	slot = bins->offsets + tile * PRIM_TYPES;
+	span.items = bins->indices + slot[0];
+	span.count = slot[PRIM_TYPES] - slot[0];
+	k = -1;
+	while (++k <= PRIM_TYPES)
+		span.runs[k] = slot[k] - slot[0];
+	return (span);
+}
@@ -0,0 +1,118 @@
+#include "../../includes/minirt_app.h"
+
+/*
+** Morton (Z-order) decode: even bits of d give x, odd bits give y
+*/
+static void	morton_point(int d, int xy[2])
+{
+	int	bit;
+
+	xy[0] = 0;
+	xy[1] = 0;
+	bit = 0;
+	while (d >> (2 * bit))
+	{
+		xy[0] |= ((d >> (2 * bit)) & 1) << bit;
+		xy[1] |= ((d >> (2 * bit + 1)) & 1) << bit;
+		bit++;
+	}
+}
+
+/*
+** Hilbert curve decode on an n x n grid, n a power of two
+*/
+static void	hilbert_point(int n, int d, int xy[2])
+{
+	int	s;
+	int	rx;
+	int	ry;
+	int	tmp;
+
+	xy[0] = 0;
+	xy[1] = 0;
+	s = 1;
+	while (s < n)
+	{
+		rx = 1 & (d / 2);
+		ry = 1 & (d ^ rx);
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				xy[0] = s - 1 - xy[0];
+				xy[1] = s - 1 - xy[1];
+			}
+			tmp = xy[0];
+			xy[0] = xy[1];
+			xy[1] = tmp;
+		}
+		xy[0] += s * rx;
+		xy[1] += s * ry;
+		d /= 4;
+		s *= 2;
+	}
+}
+
+/*
+** Walk the curve over the smallest power-of-two square covering a
+** width x height grid and keep the cells that fall inside it. Cells are
+** stored as y * width + x. Returns the number of cells written.
+*/
+int	curve_order(int order, int width, int height, int *out)
+{
+	int	n;
+	int	d;
+	int	count;
+	int	xy[2];
+
+	n = 1;
+	while (n < width || n < height)
+		n *= 2;
+	count = 0;
+	d = -1;
+	while (++d < n * n && count < width * height)
+	{
+		xy[0] = d % width;
+		xy[1] = d / width;
+		if (order == ORDER_MORTON)
+			morton_point(d, xy);
+		else if (order == ORDER_HILBERT)
+			hilbert_point(n, d, xy);
+		else if (d >= width * height)
+			break ;
+		if (xy[0] < width && xy[1] < height)
+			out[count++] = xy[1] * width + xy[0];
+	}
+	return (count);
+}
+
+/*
+** Tile sequence handed out to the workers and pixel sequence inside a
+** tile, both following the requested traversal order. The tile sequence
+** is frame scratch.
+*/
+int	traversal_build(t_render *r)
+{
+	int	pixels[TILE_SIZE * TILE_SIZE];
+	int	i;
+
+	r->tile_order = arena_alloc(&r->frame,
+			r->bins.tiles_x * r->bins.tiles_y * sizeof(int));
+	if (!r->tile_order)
+		return (FALSE);
+	curve_order(r->order, r->bins.tiles_x, r->bins.tiles_y, r->tile_order);
+	curve_order(r->order, TILE_SIZE, TILE_SIZE, pixels);
+	i = -1;
+	while (++i < TILE_SIZE * TILE_SIZE)
+		r->pixel_order[i] = (unsigned short)pixels[i];
+	return (TRUE);
+}
+
+const char	*order_name(int order)
+{
+	if (order == ORDER_MORTON)
+		return ("morton");
+	if (order == ORDER_HILBERT)
+		return ("hilbert");
+	return ("row");
+}
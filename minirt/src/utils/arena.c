@@ -0,0 +1,54 @@
+#include "../../includes/minirt_app.h"
+#include <sys/mman.h>
+
+/*
+** Reserve size bytes of address space. MAP_NORESERVE leaves untouched
+** pages free, so a generous size costs nothing until used. With huge
+** set, transparent huge pages are requested for the mapping: the kernel
+** backs it with them when it can and falls back to small pages when it
+** cannot, no pool is taken up front.
+*/
+int	arena_init(t_arena *arena, size_t size, int huge)
+{
+	size = (size + ARENA_HUGE_PAGE - 1) & ~((size_t)ARENA_HUGE_PAGE - 1);
+	arena->base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (arena->base == MAP_FAILED)
+		return (arena->base = NULL, arena->size = 0, arena->used = 0, FALSE);
+	if (huge)
+		madvise(arena->base, size, MADV_HUGEPAGE);
+	arena->size = size;
+	arena->used = 0;
+	return (TRUE);
+}
+
+/* ARENA_ALIGN-aligned block, NULL once the reservation is exhausted */
+void	*arena_alloc(t_arena *arena, size_t size)
+{
+	size_t	start;
+
+	start = (arena->used + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1);
+	if (!arena->base || start > arena->size || size > arena->size - start)
+		return (NULL);
+	arena->used = start + size;
+	return (arena->base + start);
+}
+
+size_t	arena_mark(const t_arena *arena)
+{
+	return (arena->used);
+}
+
+void	arena_reset(t_arena *arena, size_t mark)
+{
+	arena->used = mark;
+}
+
+void	arena_destroy(t_arena *arena)
+{
+	if (arena->base)
+		munmap(arena->base, arena->size);
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+}
@@ -0,0 +1,33 @@
+#include "../../includes/minirt_app.h"
+
+/* Write all n bytes of data to fd, through short writes */
+int	write_full(int fd, const void *data, size_t n)
+{
+	ssize_t	done;
+
+	while (n > 0)
+	{
+		done = write(fd, data, n);
+		if (done <= 0)
+			return (FALSE);
+		data = (const char *)data + done;
+		n -= done;
+	}
+	return (TRUE);
+}
+
+/* Read exactly n bytes from fd into data, FALSE on error or end of file */
+int	read_full(int fd, void *data, size_t n)
+{
+	ssize_t	done;
+
+	while (n > 0)
+	{
+		done = read(fd, data, n);
+		if (done <= 0)
+			return (FALSE);
+		data = (char *)data + done;
+		n -= done;
+	}
+	return (TRUE);
+}
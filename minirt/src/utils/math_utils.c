@@ -1,26 +1,74 @@
 #include "../../includes/scene_math.h"
 #include <math.h>
 
-/**
- * Helper function to solve quadratic equation ax^2 + bx + c = 0
- * Returns the smallest positive root > min_t, or -1 if none
- */
-double	solve_quadratic(double a, double b, double c, double min_t)
+/*
+** Roots of a t^2 + 2 half_b t + c = 0 without cancellation: q takes the
+** sign of -half_b so its two terms never cancel, the roots are q / a and
+** c / q. Both come out of the single reciprocal 1 / (a q). Returns 0
+** when there is no real root or the equation is degenerate (a == 0 or
+** q == 0, which only happens for the double root 0).
+*/
+static int	stable_roots(double a, double half_b, double c, double roots[2])
 {
 	double	discriminant;
-	double	sqrt_d;
-	double	t0;
-	double	t1;
+	double	q;
+	double	inv;
 
-	discriminant = b * b - 4 * a * c;
+	discriminant = half_b * half_b - a * c;
 	if (discriminant < 0)
+		return (0);
+	q = -half_b - sqrt(discriminant);
+	if (half_b < 0)
+		q = -half_b + sqrt(discriminant);
+	if (a == 0.0 || q == 0.0)
+		return (0);
+	inv = 1.0 / (a * q);
+	roots[0] = q * q * inv;
+	roots[1] = c * a * inv;
+	return (1);
+}
+
+/**
+ * Solve a t^2 + 2 half_b t + c = 0
+ * Returns the smallest root > min_t, or -1 if none
+ */
+double	solve_quadratic(double a, double half_b, double c, double min_t)
+{
+	double	roots[2];
+
+	if (!stable_roots(a, half_b, c, roots))
 		return (-1.0);
-	sqrt_d = sqrt(discriminant);
-	t0 = (-b - sqrt_d) / (2.0 * a);
-	t1 = (-b + sqrt_d) / (2.0 * a);
-	if (t0 > min_t && (t0 < t1 || t1 <= min_t))
-		return (t0);
-	if (t1 > min_t)
-		return (t1);
+	if (roots[0] > min_t && (roots[0] < roots[1] || roots[1] <= min_t))
+		return (roots[0]);
+	if (roots[1] > min_t)
+		return (roots[1]);
 	return (-1.0);
 }
+
+/**
+ * Both real roots of a t^2 + 2 half_b t + c = 0 in ascending order
+ * Returns 1 on success, 0 when the equation has no real root
+ */
+int	solve_quadratic_roots(double a, double half_b, double c, double roots[2])
+{
+	double	tmp;
+
+	if (!stable_roots(a, half_b, c, roots))
+		return (0);
+	if (roots[0] > roots[1])
+	{
+		tmp = roots[0];
+		roots[0] = roots[1];
+		roots[1] = tmp;
+	}
+	return (1);
+}
+
+/**
+ * Dot product accumulated in double, for terms that cancel against
+ * each other before reaching a discriminant
+ */
+double	vec3_dot_wide(t_vec3 v1, t_vec3 v2)
+{
+	return ((double)v1.x * v2.x + (double)v1.y * v2.y + (double)v1.z * v2.z);
+}
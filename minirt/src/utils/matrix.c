@@ -73,11 +73,11 @@ t_matrix4	matrix4_translation(t_vec3 translation)
 /*
 ** Create rotation matrix around X axis
 */
-t_matrix4	matrix4_rotation_x(double angle)
+t_matrix4	matrix4_rotation_x(t_real angle)
 {
 	t_matrix4	m;
-	double		cos_a;
-	double		sin_a;
+	t_real		cos_a;
+	t_real		sin_a;
 
 	m = matrix4_identity();
 	cos_a = cos(angle);
@@ -92,11 +92,11 @@ t_matrix4	matrix4_rotation_x(double angle)
 /*
 ** Create rotation matrix around Y axis
 */
-t_matrix4	matrix4_rotation_y(double angle)
+t_matrix4	matrix4_rotation_y(t_real angle)
 {
 	t_matrix4	m;
-	double		cos_a;
-	double		sin_a;
+	t_real		cos_a;
+	t_real		sin_a;
 
 	m = matrix4_identity();
 	cos_a = cos(angle);
@@ -111,11 +111,11 @@ t_matrix4	matrix4_rotation_y(double angle)
 /*
 ** Create rotation matrix around Z axis
 */
-t_matrix4	matrix4_rotation_z(double angle)
+t_matrix4	matrix4_rotation_z(t_real angle)
 {
 	t_matrix4	m;
-	double		cos_a;
-	double		sin_a;
+	t_real		cos_a;
+	t_real		sin_a;
 
 	m = matrix4_identity();
 	cos_a = cos(angle);
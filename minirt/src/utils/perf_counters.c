@@ -0,0 +1,72 @@
+#include "../../includes/minirt_app.h"
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+/*
+** Hardware events sampled around a render, in t_perf_counters order:
+** cache references and misses (last level) and L1 data read misses
+*/
+static void	perf_attr(struct perf_event_attr *attr, int counter)
+{
+	memset(attr, 0, sizeof(struct perf_event_attr));
+	attr->size = sizeof(struct perf_event_attr);
+	attr->disabled = 1;
+	attr->inherit = 1;
+	attr->exclude_kernel = 1;
+	attr->exclude_hv = 1;
+	attr->type = PERF_TYPE_HARDWARE;
+	if (counter == PERF_CACHE_REFS)
+		attr->config = PERF_COUNT_HW_CACHE_REFERENCES;
+	else if (counter == PERF_CACHE_MISSES)
+		attr->config = PERF_COUNT_HW_CACHE_MISSES;
+	else
+	{
+		attr->type = PERF_TYPE_HW_CACHE;
+		attr->config = PERF_COUNT_HW_CACHE_L1D
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	}
+}
+
+/*
+** Open and enable the counters. inherit is set, so render threads
+** created afterwards are counted too. Counters the kernel refuses
+** (no PMU, perf_event_paranoid) are left at fd -1 and reported as n/a.
+*/
+void	perf_counters_start(t_perf_counters *perf)
+{
+	struct perf_event_attr	attr;
+	int						i;
+
+	i = -1;
+	while (++i < PERF_NUM_COUNTERS)
+	{
+		perf_attr(&attr, i);
+		perf->fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		perf->value[i] = -1;
+		if (perf->fd[i] < 0)
+			continue ;
+		ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void	perf_counters_stop(t_perf_counters *perf)
+{
+	int	i;
+
+	i = -1;
+	while (++i < PERF_NUM_COUNTERS)
+	{
+		if (perf->fd[i] < 0)
+			continue ;
+		ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(perf->fd[i], &perf->value[i], sizeof(long long))
+			!= sizeof(long long))
+			perf->value[i] = -1;
+		close(perf->fd[i]);
+		perf->fd[i] = -1;
+	}
+}
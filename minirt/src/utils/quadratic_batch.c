@@ -0,0 +1,42 @@
+#include "../../includes/scene_math.h"
+#include <math.h>
+
+/*
+** Same formulation as solve_quadratic, written without branches so the
+** loop becomes SIMD code: every lane computes both roots and the
+** selects pick the result. Lanes without a real root, with a == 0 or
+** with the double root 0 (NaN roots) report -1. The Makefile builds
+** this file with VECTOR_FLAGS, without them the compiler has to keep
+** sqrt and the division scalar.
+*/
+void	solve_quadratic_batch(t_quadratics *batch, double min_t)
+{
+	double	disc;
+	double	q;
+	double	inv;
+	double	near;
+	double	far;
+	int		i;
+
+	i = 0;
+	while (i < batch->count)
+	{
+		disc = batch->half_b[i] * batch->half_b[i] - batch->a[i] * batch->c[i];
+		q = sqrt(disc * (disc > 0));
+		q = -batch->half_b[i] + (2 * (batch->half_b[i] < 0) - 1) * q;
+		inv = 1.0 / (batch->a[i] * q);
+		near = q * q * inv;
+		far = batch->c[i] * batch->a[i] * inv;
+		if (far < near)
+		{
+			far = near;
+			near = batch->c[i] * batch->a[i] * inv;
+		}
+		if (!(near > min_t))
+			near = far;
+		if (!(near > min_t) || disc < 0 || batch->a[i] == 0.0)
+			near = -1.0;
+		batch->t[i] = near;
+		i++;
+	}
+}
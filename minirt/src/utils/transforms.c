@@ -55,7 +55,7 @@ void	transform_rotate(t_transform *transform, t_vec3 rotation)
 /*
 ** Apply uniform scale to transform
 */
-void	transform_scale_uniform(t_transform *transform, double scale)
+void	transform_scale_uniform(t_transform *transform, t_real scale)
 {
 	transform->scale = vec3_mult(transform->scale, scale);
 	transform_update_matrix(transform);
@@ -125,6 +125,47 @@ void	transform_cone(t_cone *cone, t_transform *transform)
 		cone->height *= transform->scale.y;
 }
 
+/*
+** Transform a box, quad or disc: center and direction follow the matrix,
+** sizes only a uniform scale
+*/
+void	transform_box(t_box *box, t_transform *transform)
+{
+	box->center = matrix4_transform_point(transform->matrix, box->center);
+	box->axis = vec3_normalize(matrix4_transform_direction(transform->matrix,
+				box->axis));
+	box->side = vec3_normalize(matrix4_transform_direction(transform->matrix,
+				box->side));
+	if (transform->scale.x == transform->scale.y
+		&& transform->scale.y == transform->scale.z)
+		box->size = vec3_mult(box->size, transform->scale.x);
+}
+
+void	transform_quad(t_quad *quad, t_transform *transform)
+{
+	quad->center = matrix4_transform_point(transform->matrix, quad->center);
+	quad->normal = vec3_normalize(matrix4_transform_direction(
+				transform->matrix, quad->normal));
+	quad->side = vec3_normalize(matrix4_transform_direction(
+				transform->matrix, quad->side));
+	if (transform->scale.x == transform->scale.y
+		&& transform->scale.y == transform->scale.z)
+	{
+		quad->width *= transform->scale.x;
+		quad->height *= transform->scale.x;
+	}
+}
+
+void	transform_disc(t_disc *disc, t_transform *transform)
+{
+	disc->center = matrix4_transform_point(transform->matrix, disc->center);
+	disc->normal = vec3_normalize(matrix4_transform_direction(
+				transform->matrix, disc->normal));
+	if (transform->scale.x == transform->scale.y
+		&& transform->scale.y == transform->scale.z)
+		disc->diameter *= transform->scale.x;
+}
+
 /*
 ** Transform a camera
 */
@@ -136,6 +177,16 @@ void	transform_camera(t_camera *camera, t_transform *transform)
 			camera->orientation);
 }
 
+static void	transform_flat(t_object *object, t_transform *transform)
+{
+	if (object->type == BOX)
+		transform_box(&object->data.box, transform);
+	else if (object->type == QUAD)
+		transform_quad(&object->data.quad, transform);
+	else if (object->type == DISC)
+		transform_disc(&object->data.disc, transform);
+}
+
 /*
 ** Translate object in scene
 */
@@ -156,6 +207,35 @@ void	scene_translate_object(t_scene *scene, int obj_index, t_vec3 delta)
 			&transform);
 	else if (scene->objects[obj_index].type == CONE)
 		transform_cone(&scene->objects[obj_index].data.cone, &transform);
+	else
+		transform_flat(&scene->objects[obj_index], &transform);
+}
+
+/* Boxes and quads turn their side with their axis or normal */
+static void	rotate_flat(t_object *object, t_vec3 axis, t_real angle)
+{
+	t_vec3	*direction;
+	t_vec3	*side;
+
+	side = NULL;
+	if (object->type == BOX)
+	{
+		direction = &object->data.box.axis;
+		side = &object->data.box.side;
+	}
+	else if (object->type == QUAD)
+	{
+		direction = &object->data.quad.normal;
+		side = &object->data.quad.side;
+	}
+	else if (object->type == DISC)
+		direction = &object->data.disc.normal;
+	else
+		return ;
+	*direction = vec3_normalize(vec3_rotate_around_axis(*direction, axis,
+				angle));
+	if (side)
+		*side = vec3_normalize(vec3_rotate_around_axis(*side, axis, angle));
 }
 
 /*
@@ -164,7 +244,7 @@ void	scene_translate_object(t_scene *scene, int obj_index, t_vec3 delta)
 void	scene_rotate_object(t_scene *scene, int obj_index, t_vec3 rotation)
 {
 	t_vec3	axis;
-	double	angle;
+	t_real	angle;
 
 	if (obj_index < 0 || obj_index >= scene->num_objects)
 		return ;
@@ -200,12 +280,14 @@ void	scene_rotate_object(t_scene *scene, int obj_index, t_vec3 rotation)
 				axis, angle);
 		scene->objects[obj_index].data.cone.axis = vec3_normalize(scene->objects[obj_index].data.cone.axis);
 	}
+	else
+		rotate_flat(&scene->objects[obj_index], axis, angle);
 }
 
 /*
 ** Scale object in scene
 */
-void	scene_scale_object(t_scene *scene, int obj_index, double scale)
+void	scene_scale_object(t_scene *scene, int obj_index, t_real scale)
 {
 	t_transform	transform;
 
@@ -220,6 +302,8 @@ void	scene_scale_object(t_scene *scene, int obj_index, double scale)
 			&transform);
 	else if (scene->objects[obj_index].type == CONE)
 		transform_cone(&scene->objects[obj_index].data.cone, &transform);
+	else
+		transform_flat(&scene->objects[obj_index], &transform);
 }
 
 /*
@@ -235,7 +319,8 @@ void	scene_translate_camera(t_scene *scene, t_vec3 delta)
 }
 
 /*
-** Rotate camera in scene
+** Rotate camera in scene, in place: the orientation turns, the position
+** stays where it is
 */
 void	scene_rotate_camera(t_scene *scene, t_vec3 rotation)
 {
@@ -243,5 +328,13 @@ void	scene_rotate_camera(t_scene *scene, t_vec3 rotation)
 
 	transform = transform_identity();
 	transform_rotate(&transform, rotation);
-	transform_camera(&scene->camera, &transform);
+	scene->camera.orientation = matrix4_transform_direction(transform.matrix,
+			scene->camera.orientation);
+}
+
+/* A world position, such as a --camera override, in scene coordinates */
+t_vec3	scene_rebase(const t_scene *scene, t_vec3 world)
+{
+	return (vec3_create(world.x - scene->base[0], world.y - scene->base[1],
+			world.z - scene->base[2]));
 }
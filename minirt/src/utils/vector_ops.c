@@ -2,7 +2,7 @@
 #include <math.h>
 
 // Create a new vector
-t_vec3	vec3_create(double x, double y, double z)
+t_vec3	vec3_create(t_real x, t_real y, t_real z)
 {
 	t_vec3	v;
 
@@ -22,12 +22,12 @@ t_vec3	vec3_sub(t_vec3 v1, t_vec3 v2)
 	return (vec3_create(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z));
 }
 
-t_vec3	vec3_mult(t_vec3 v, double t)
+t_vec3	vec3_mult(t_vec3 v, t_real t)
 {
 	return (vec3_create(v.x * t, v.y * t, v.z * t));
 }
 
-t_vec3	vec3_div(t_vec3 v, double t)
+t_vec3	vec3_div(t_vec3 v, t_real t)
 {
 	return (vec3_create(v.x / t, v.y / t, v.z / t));
 }
@@ -38,24 +38,24 @@ t_vec3	vec3_cross(t_vec3 v1, t_vec3 v2)
 			v1.x * v2.y - v1.y * v2.x));
 }
 
-double	vec3_dot(t_vec3 v1, t_vec3 v2)
+t_real	vec3_dot(t_vec3 v1, t_vec3 v2)
 {
 	return (v1.x * v2.x + v1.y * v2.y + v1.z * v2.z);
 }
 
-double	vec3_length_squared(t_vec3 v)
+t_real	vec3_length_squared(t_vec3 v)
 {
 	return (vec3_dot(v, v));
 }
 
-double	vec3_length(t_vec3 v)
+t_real	vec3_length(t_vec3 v)
 {
-	return (sqrt(vec3_length_squared(v)));
+	return (RT_SQRT(vec3_length_squared(v)));
 }
 
 t_vec3	vec3_normalize(t_vec3 v)
 {
-	double	len;
+	t_real	len;
 
 	len = vec3_length(v);
 	if (len == 0)
@@ -68,11 +68,11 @@ t_vec3	reflect(t_vec3 v, t_vec3 n)
 	return (vec3_sub(v, vec3_mult(n, 2 * vec3_dot(v, n))));
 }
 
-t_vec3	vec3_rotate_around_axis(t_vec3 v, t_vec3 axis, double angle)
+t_vec3	vec3_rotate_around_axis(t_vec3 v, t_vec3 axis, t_real angle)
 {
 	t_vec3	u;
-	double	cos_a;
-	double	sin_a;
+	t_real	cos_a;
+	t_real	sin_a;
 
 	u = vec3_normalize(axis);
 	cos_a = cos(angle);
@@ -80,3 +80,18 @@ t_vec3	vec3_rotate_around_axis(t_vec3 v, t_vec3 axis, double angle)
 	return (vec3_add(vec3_add(vec3_mult(v, cos_a), vec3_mult(vec3_cross(u, v),
 					sin_a)), vec3_mult(u, vec3_dot(u, v) * (1 - cos_a))));
 }
+
+/*
+** Two unit vectors completing axis to an orthonormal frame. For the
+** y axis this gives x and z, so floor planes map u, v to world x, z.
+*/
+void	vec3_frame(t_vec3 axis, t_vec3 *e1, t_vec3 *e2)
+{
+	t_vec3	ref;
+
+	ref = vec3_create(0, 0, 1);
+	if (fabs(axis.z) > 0.9)
+		ref = vec3_create(0, 1, 0);
+	*e1 = vec3_normalize(vec3_cross(axis, ref));
+	*e2 = vec3_cross(*e1, axis);
+}
@@ -0,0 +1,125 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+** imgcmp: compare a rendered PPM against a reference one.
+**
+** imgcmp <reference.ppm> <image.ppm> <min_psnr> <max_error> [diff.ppm]
+**
+** Prints "psnr max_error" (psnr is "inf" for identical images) and exits
+** with 0 when both thresholds hold, 1 when they do not and 2 when the
+** images cannot be read or differ in size. On failure the per-channel
+** absolute difference, amplified by DIFF_GAIN, is written to diff.ppm.
+*/
+
+#define TRUE 1
+#define FALSE 0
+#define DIFF_GAIN 8
+
+typedef struct s_ppm
+{
+	unsigned char	*data;
+	int				width;
+	int				height;
+}					t_ppm;
+
+static int	read_ppm(const char *path, t_ppm *img)
+{
+	FILE	*file;
+	size_t	size;
+	int		maxval;
+	int		ok;
+
+	img->data = NULL;
+	file = fopen(path, "rb");
+	if (!file)
+		return (fprintf(stderr, "Error: Could not open %s\n", path), FALSE);
+	ok = (fscanf(file, "P6 %d %d %d", &img->width, &img->height, &maxval) == 3
+			&& fgetc(file) != EOF && maxval == 255 && img->width > 0
+			&& img->height > 0);
+	size = (size_t)img->width * img->height * 3;
+	if (ok)
+		img->data = malloc(size);
+	ok = (ok && img->data && fread(img->data, 1, size, file) == size);
+	fclose(file);
+	if (!ok)
+		fprintf(stderr, "Error: %s is not a 8-bit binary PPM\n", path);
+	return (ok);
+}
+
+static int	write_diff(const char *path, const t_ppm *a, const t_ppm *b)
+{
+	FILE	*file;
+	size_t	size;
+	size_t	i;
+	int		d;
+
+	file = fopen(path, "wb");
+	if (!file)
+		return (fprintf(stderr, "Error: Could not write %s\n", path), FALSE);
+	fprintf(file, "P6\n%d %d\n255\n", a->width, a->height);
+	size = (size_t)a->width * a->height * 3;
+	i = 0;
+	while (i < size)
+	{
+		d = abs(a->data[i] - b->data[i]) * DIFF_GAIN;
+		if (d > 255)
+			d = 255;
+		fputc(d, file);
+		i++;
+	}
+	return (fclose(file) == 0);
+}
+
+/* Mean squared error over all channels, largest single channel error */
+static double	compare(const t_ppm *a, const t_ppm *b, int *max_error)
+{
+	size_t	size;
+	size_t	i;
+	double	sum;
+	int		d;
+
+	size = (size_t)a->width * a->height * 3;
+	sum = 0.0;
+	*max_error = 0;
+	i = 0;
+	while (i < size)
+	{
+		d = abs(a->data[i] - b->data[i]);
+		if (d > *max_error)
+			*max_error = d;
+		sum += (double)d * d;
+		i++;
+	}
+	return (sum / size);
+}
+
+int	main(int argc, char **argv)
+{
+	t_ppm	ref;
+	t_ppm	img;
+	double	mse;
+	double	psnr;
+	int		max_error;
+
+	if (argc != 5 && argc != 6)
+		return (fprintf(stderr, "Usage: ./imgcmp <reference.ppm> <image.ppm> "
+				"<min_psnr> <max_error> [diff.ppm]\n"), 2);
+	img.data = NULL;
+	if (!read_ppm(argv[1], &ref) || !read_ppm(argv[2], &img))
+		return (free(ref.data), free(img.data), 2);
+	if (ref.width != img.width || ref.height != img.height)
+		return (fprintf(stderr, "Error: Images differ in size\n"),
+			free(ref.data), free(img.data), 2);
+	mse = compare(&ref, &img, &max_error);
+	psnr = INFINITY;
+	if (mse > 0.0)
+		psnr = 10.0 * log10(255.0 * 255.0 / mse);
+	printf("%.2f %d\n", psnr, max_error);
+	if (psnr >= atof(argv[3]) && max_error <= atoi(argv[4]))
+		return (free(ref.data), free(img.data), 0);
+	if (argc == 6)
+		write_diff(argv[5], &ref, &img);
+	return (free(ref.data), free(img.data), 1);
+}
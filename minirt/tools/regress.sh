@@ -0,0 +1,116 @@
+#!/bin/sh
+#
+# Golden-image and timing regression over scenes/, run from minirt/:
+#
+#   tools/regress.sh update   render every scene into the reference set
+#   tools/regress.sh check    render again and compare with the references
+#
+# Scenes are rendered headlessly at REGRESS_SIZE, keeping the best wall
+# time of REGRESS_RUNS runs. A scene fails when its image drops below
+# REGRESS_PSNR dB or has a channel off by more than REGRESS_MAX_ERROR,
+# or when its time exceeds the reference by more than REGRESS_TIME_TOL
+# percent plus REGRESS_TIME_SLACK ms. Image failures leave a diff in
+# $REGRESS_DIR/diff. Scenes minirt rejects (empty files, missing
+# elements) are recorded as such and must keep being rejected.
+# References and timings are machine-local, record them with update on a
+# known-good build before changing anything.
+
+MINIRT=${MINIRT:-./minirt}
+IMGCMP=${IMGCMP:-tools/imgcmp}
+DIR=${REGRESS_DIR:-regress}
+SIZE=${REGRESS_SIZE:-480x270}
+RUNS=${REGRESS_RUNS:-3}
+PSNR=${REGRESS_PSNR:-40}
+MAX_ERROR=${REGRESS_MAX_ERROR:-32}
+TIME_TOL=${REGRESS_TIME_TOL:-25}
+TIME_SLACK=${REGRESS_TIME_SLACK:-50}
+
+now_ms() {
+	echo $(($(date +%s%N) / 1000000))
+}
+
+# render <scene> <image>: best wall time in ms, fails if minirt does
+render() {
+	best=
+	run=0
+	while [ $run -lt "$RUNS" ]; do
+		start=$(now_ms)
+		"$MINIRT" "$1" --size "$SIZE" --output "$2" >/dev/null 2>&1 || return 1
+		took=$(($(now_ms) - start))
+		if [ -z "$best" ] || [ $took -lt $best ]; then
+			best=$took
+		fi
+		run=$((run + 1))
+	done
+	echo $best
+}
+
+# check_scene <name> <scene>: prints one result line, fails on regression
+check_scene() {
+	ref=$DIR/ref/$1.ppm
+	base=$(awk -v n="$1" '$1 == n { print $2 }' "$DIR/times.txt" 2>/dev/null)
+	if [ "$base" = rejected ]; then
+		if render "$2" "$DIR/out/$1.ppm" >/dev/null; then
+			echo "FAIL $1: accepted, the reference rejects it"
+			return 1
+		fi
+		printf 'ok   %-44s rejected\n' "$1"
+		return 0
+	fi
+	if [ ! -f "$ref" ] || [ -z "$base" ]; then
+		echo "FAIL $1: no reference, run make regress-update first"
+		return 1
+	fi
+	if ! took=$(render "$2" "$DIR/out/$1.ppm"); then
+		echo "FAIL $1: render failed"
+		return 1
+	fi
+	rm -f "$DIR/diff/$1.ppm"
+	result=$("$IMGCMP" "$ref" "$DIR/out/$1.ppm" "$PSNR" "$MAX_ERROR" \
+		"$DIR/diff/$1.ppm")
+	status=$?
+	limit=$((base + base * TIME_TOL / 100 + TIME_SLACK))
+	set -- "$1" $result
+	line=$(printf '%-44s psnr %6s max %3s %6s ms (ref %s ms)' \
+		"$1" "$2" "$3" "$took" "$base")
+	if [ $status -ne 0 ]; then
+		echo "FAIL $line, diff in $DIR/diff/$1.ppm"
+	elif [ "$took" -gt $limit ]; then
+		echo "FAIL $line, slower than $limit ms"
+	else
+		echo "ok   $line"
+		return 0
+	fi
+	return 1
+}
+
+case "$1" in
+	update | check) ;;
+	*)
+		echo "Usage: tools/regress.sh update|check"
+		exit 2
+		;;
+esac
+mkdir -p "$DIR/ref" "$DIR/out" "$DIR/diff" || exit 2
+if [ "$1" = update ]; then
+	: >"$DIR/times.txt"
+fi
+mode=$1
+total=0
+failed=0
+for scene in scenes/*.rt scenes/sphere_scenes/*.rt; do
+	name=$(echo "${scene#scenes/}" | sed 's|/|_|g; s|\.rt$||')
+	total=$((total + 1))
+	if [ "$mode" = check ]; then
+		check_scene "$name" "$scene" || failed=$((failed + 1))
+	elif took=$(render "$scene" "$DIR/ref/$name.ppm"); then
+		echo "$name $took" >>"$DIR/times.txt"
+		printf 'ref  %-44s %6s ms\n' "$name" "$took"
+	else
+		echo "$name rejected" >>"$DIR/times.txt"
+		rm -f "$DIR/ref/$name.ppm"
+		printf 'ref  %-44s rejected\n' "$name"
+	fi
+done
+echo "regress: $total scenes, $failed failed"
+[ $failed -eq 0 ]
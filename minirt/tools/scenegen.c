@@ -0,0 +1,349 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+** scenegen: write a synthetic .rt scene for parser and render scaling
+** tests. Output only depends on the arguments: the same seed gives the
+** same file.
+**
+** scenegen [--count n] [--dist uniform|clustered|nested|huge]
+**          [--seed s] [--types sp,cy,cn,pl] [--output file.rt]
+**
+** Object density is kept constant, the scene grows with cbrt(n) up to
+** a cube that stays inside the parser's 1000 unit position warning.
+*/
+
+#define TRUE 1
+#define FALSE 0
+
+#define GEN_SPACING 4.0
+#define GEN_MAX_HALF 450.0
+#define GEN_MIN_SIZE 0.1
+#define GEN_CLUSTER_SIZE 2000
+#define GEN_NESTED_SCALE 0.45
+#define GEN_HUGE_EVERY 1000000
+#define GEN_BUFFER_SIZE 4194304
+
+#define DIST_UNIFORM 0
+#define DIST_CLUSTERED 1
+#define DIST_NESTED 2
+#define DIST_HUGE 3
+
+#define GEN_USAGE "Usage: ./scenegen [--count n] \
+[--dist uniform|clustered|nested|huge] [--seed s] [--types sp,cy,cn,pl] \
+[--output file.rt]\n"
+
+typedef struct s_gen
+{
+	unsigned long	count;
+	unsigned long	seed;
+	unsigned long	state;
+	int				dist;
+	const char		*types[4];
+	int				num_types;
+	double			half;
+	double			*clusters;
+	unsigned long	num_clusters;
+	unsigned long	huge_step;
+	int				levels;
+	FILE			*out;
+}					t_gen;
+
+typedef struct s_spot
+{
+	double			pos[3];
+	double			size;
+}					t_spot;
+
+/* splitmix64, a 53-bit mantissa makes the double exact on every libc */
+static double	rnd(t_gen *g)
+{
+	unsigned long	z;
+
+	g->state += 0x9E3779B97F4A7C15UL;
+	z = g->state;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+	z ^= z >> 31;
+	return ((double)(z >> 11) * (1.0 / 9007199254740992.0));
+}
+
+static double	rnd_range(t_gen *g, double lo, double hi)
+{
+	return (lo + (hi - lo) * rnd(g));
+}
+
+/* Irwin-Hall approximation of a unit normal, no libm involved */
+static double	rnd_gauss(t_gen *g)
+{
+	return ((rnd(g) + rnd(g) + rnd(g) + rnd(g) - 2.0) * 1.7320508075688772);
+}
+
+static void	rnd_axis(t_gen *g, double *v)
+{
+	double	len;
+
+	len = 0.0;
+	while (len < 1e-3)
+	{
+		v[0] = rnd_range(g, -1.0, 1.0);
+		v[1] = rnd_range(g, -1.0, 1.0);
+		v[2] = rnd_range(g, -1.0, 1.0);
+		len = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+		if (len > 1.0)
+			len = 0.0;
+	}
+	len = sqrt(len);
+	v[0] /= len;
+	v[1] /= len;
+	v[2] /= len;
+}
+
+static double	clamp_half(t_gen *g, double v)
+{
+	if (v < -g->half)
+		return (-g->half);
+	if (v > g->half)
+		return (g->half);
+	return (v);
+}
+
+static void	spot_uniform(t_gen *g, t_spot *s, double scale)
+{
+	s->pos[0] = rnd_range(g, -g->half, g->half);
+	s->pos[1] = rnd_range(g, -g->half, g->half);
+	s->pos[2] = rnd_range(g, -g->half, g->half);
+	s->size = GEN_SPACING * scale * rnd_range(g, 0.2, 0.6);
+}
+
+static void	spot_clustered(t_gen *g, t_spot *s)
+{
+	double			*c;
+	double			sigma;
+	int				k;
+
+	c = g->clusters + 3 * (unsigned long)(rnd(g) * g->num_clusters);
+	sigma = g->half * 0.25 / cbrt((double)g->num_clusters);
+	k = -1;
+	while (++k < 3)
+		s->pos[k] = clamp_half(g, c[k] + sigma * rnd_gauss(g));
+	s->size = GEN_SPACING * rnd_range(g, 0.1, 0.3);
+}
+
+/*
+** Octree of clusters inside clusters: each base-8 digit of the object
+** index picks a child box of the current one, GEN_NESTED_SCALE times
+** smaller and jittered, so the scene is dense boxes within empty boxes
+** at every level.
+*/
+static void	spot_nested(t_gen *g, t_spot *s, unsigned long index)
+{
+	double	h;
+	int		level;
+	int		k;
+	int		digit;
+
+	h = g->half;
+	s->pos[0] = 0.0;
+	s->pos[1] = 0.0;
+	s->pos[2] = 0.0;
+	level = -1;
+	while (++level < g->levels)
+	{
+		digit = index & 7;
+		index >>= 3;
+		k = -1;
+		while (++k < 3)
+			s->pos[k] += h * (((digit >> k) & 1) - 0.5)
+				+ h * rnd_range(g, -0.05, 0.05);
+		h *= GEN_NESTED_SCALE;
+	}
+	s->size = h * rnd_range(g, 0.5, 1.5);
+}
+
+static void	next_spot(t_gen *g, t_spot *s, unsigned long index)
+{
+	if (g->dist == DIST_CLUSTERED)
+		spot_clustered(g, s);
+	else if (g->dist == DIST_NESTED)
+		spot_nested(g, s, index);
+	else if (g->dist == DIST_HUGE && index % g->huge_step == 0)
+	{
+		spot_uniform(g, s, 1.0);
+		s->size = g->half * rnd_range(g, 0.3, 0.6);
+	}
+	else if (g->dist == DIST_HUGE)
+		spot_uniform(g, s, 0.25);
+	else
+		spot_uniform(g, s, 1.0);
+	if (s->size < GEN_MIN_SIZE)
+		s->size = GEN_MIN_SIZE;
+}
+
+static void	write_object(t_gen *g, const char *type, t_spot *s)
+{
+	double	a[3];
+	int		rgb[3];
+	int		k;
+
+	k = -1;
+	while (++k < 3)
+		rgb[k] = (int)rnd_range(g, 40.0, 256.0);
+	rnd_axis(g, a);
+	fprintf(g->out, "%s %.3f,%.3f,%.3f ", type, s->pos[0], s->pos[1], s->pos[2]);
+	if (type[0] == 's')
+		fprintf(g->out, "%.3f", s->size);
+	else if (type[0] == 'p')
+		fprintf(g->out, "%.6f,%.6f,%.6f", a[0], a[1], a[2]);
+	else if (type[1] == 'y')
+		fprintf(g->out, "%.6f,%.6f,%.6f %.3f %.3f", a[0], a[1], a[2],
+			s->size * 0.5, s->size);
+	else
+		fprintf(g->out, "%.6f,%.6f,%.6f %.1f %.3f", a[0], a[1], a[2],
+			rnd_range(g, 10.0, 35.0), s->size);
+	fprintf(g->out, " %d,%d,%d\n", rgb[0], rgb[1], rgb[2]);
+}
+
+/* Camera in front of and above the cube looking at its center, floor below */
+static void	write_header(t_gen *g)
+{
+	static const char	*names[] = {"uniform", "clustered", "nested", "huge"};
+	double				h;
+	double				len;
+
+	h = g->half;
+	len = sqrt(0.6 * 0.6 + 2.1 * 2.1);
+	fprintf(g->out, "# scenegen --count %lu --dist %s --seed %lu\n",
+		g->count, names[g->dist], g->seed);
+	fprintf(g->out, "A 0.2 255,255,255\n");
+	fprintf(g->out, "C 0.000,%.3f,%.3f 0.000000,%.6f,%.6f 70\n",
+		0.6 * h, -2.1 * h, -0.6 / len, 2.1 / len);
+	fprintf(g->out, "L %.3f,%.3f,%.3f 0.7 255,255,255\n",
+		-0.8 * h, 1.4 * h, -0.8 * h);
+	fprintf(g->out, "pl 0.000,%.3f,0.000 0.000000,1.000000,0.000000 "
+		"200,200,200\n", -h - 1.0);
+}
+
+static int	parse_types(t_gen *g, char *list)
+{
+	char	*tok;
+
+	g->num_types = 0;
+	tok = strtok(list, ",");
+	while (tok)
+	{
+		if (g->num_types == 4 || (strcmp(tok, "sp") && strcmp(tok, "cy")
+				&& strcmp(tok, "cn") && strcmp(tok, "pl")))
+			return (fprintf(stderr, "Error: Unknown object type '%s'\n", tok),
+				FALSE);
+		g->types[g->num_types++] = tok;
+		tok = strtok(NULL, ",");
+	}
+	return (g->num_types > 0);
+}
+
+static int	parse_dist(t_gen *g, const char *name)
+{
+	if (strcmp(name, "uniform") == 0)
+		g->dist = DIST_UNIFORM;
+	else if (strcmp(name, "clustered") == 0)
+		g->dist = DIST_CLUSTERED;
+	else if (strcmp(name, "nested") == 0)
+		g->dist = DIST_NESTED;
+	else if (strcmp(name, "huge") == 0)
+		g->dist = DIST_HUGE;
+	else
+		return (fprintf(stderr, "Error: Unknown distribution '%s'\n", name),
+			FALSE);
+	return (TRUE);
+}
+
+static int	parse_args(int argc, char **argv, t_gen *g, const char **path)
+{
+	static char	defaults[] = "sp,cy,cn";
+	int			i;
+	int			ok;
+
+	ok = parse_types(g, defaults);
+	i = 0;
+	while (ok && ++i < argc)
+	{
+		if (i + 1 >= argc)
+			ok = FALSE;
+		else if (strcmp(argv[i], "--count") == 0)
+			g->count = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--seed") == 0)
+			g->seed = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--dist") == 0)
+			ok = parse_dist(g, argv[++i]);
+		else if (strcmp(argv[i], "--types") == 0)
+			ok = parse_types(g, argv[++i]);
+		else if (strcmp(argv[i], "--output") == 0)
+			*path = argv[++i];
+		else
+			ok = FALSE;
+	}
+	if (!ok)
+		fprintf(stderr, GEN_USAGE);
+	return (ok);
+}
+
+/* Cluster centers and nesting depth are drawn before any object */
+static int	setup(t_gen *g)
+{
+	unsigned long	i;
+
+	g->state = g->seed;
+	g->half = GEN_SPACING * 0.5 * cbrt((double)g->count);
+	if (g->half > GEN_MAX_HALF)
+		g->half = GEN_MAX_HALF;
+	if (g->half < GEN_SPACING)
+		g->half = GEN_SPACING;
+	g->huge_step = g->count / (4 + g->count / GEN_HUGE_EVERY) + 1;
+	g->levels = 1;
+	while (g->levels < 20 && (1UL << (3 * g->levels)) < g->count)
+		g->levels++;
+	g->num_clusters = g->count / GEN_CLUSTER_SIZE + 1;
+	g->clusters = malloc(sizeof(double) * 3 * g->num_clusters);
+	if (!g->clusters)
+		return (fprintf(stderr, "Error: Memory allocation failed\n"), FALSE);
+	i = 0;
+	while (i < 3 * g->num_clusters)
+		g->clusters[i++] = rnd_range(g, -0.8 * g->half, 0.8 * g->half);
+	return (TRUE);
+}
+
+int	main(int argc, char **argv)
+{
+	t_gen			g;
+	t_spot			s;
+	const char		*path;
+	unsigned long	i;
+
+	memset(&g, 0, sizeof(t_gen));
+	g.count = 1000;
+	path = NULL;
+	if (!parse_args(argc, argv, &g, &path) || !setup(&g))
+		return (1);
+	g.out = stdout;
+	if (path)
+		g.out = fopen(path, "w");
+	if (!g.out)
+		return (fprintf(stderr, "Error: Could not open %s\n", path),
+			free(g.clusters), 1);
+	setvbuf(g.out, NULL, _IOFBF, GEN_BUFFER_SIZE);
+	write_header(&g);
+	i = 0;
+	while (i < g.count)
+	{
+		next_spot(&g, &s, i);
+		write_object(&g, g.types[(int)(rnd(&g) * g.num_types)], &s);
+		i++;
+	}
+	free(g.clusters);
+	if (fclose(g.out) != 0)
+		return (fprintf(stderr, "Error: Could not write scene\n"), 1);
+	return (0);
+}